@@ -0,0 +1,769 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include "generate.hpp"
+#include "rito/types.hpp"
+
+using namespace Rito;
+
+namespace Rito::Bench::GenerateImpl {
+    // Growing little endian buffer, offsets stay valid while it grows
+    struct Writer {
+        std::vector<uint8_t> data;
+
+        inline uint32_t alloc(size_t size, size_t align = 4) {
+            data.resize((data.size() + align - 1) / align * align);
+            auto const offset = static_cast<uint32_t>(data.size());
+            data.resize(data.size() + size);
+            return offset;
+        }
+
+        template<typename T>
+        inline void put(uint32_t offset, T const& value) {
+            std::memcpy(data.data() + offset, &value, sizeof(T));
+        }
+
+        template<typename T>
+        inline uint32_t write(T const& value) {
+            auto const offset = alloc(sizeof(T), 1);
+            put(offset, value);
+            return offset;
+        }
+
+        inline uint32_t write_bytes(std::string_view bytes) {
+            auto const offset = alloc(bytes.size(), 1);
+            std::memcpy(data.data() + offset, bytes.data(), bytes.size());
+            return offset;
+        }
+
+        template<typename P>
+        inline void write_string(std::string_view value) {
+            write(static_cast<P>(value.size()));
+            write_bytes(value);
+        }
+
+        inline uint32_t write_cstr(std::string_view value) {
+            auto const offset = write_bytes(value);
+            write(char {});
+            return offset;
+        }
+
+        // Offset from field to target, as stored by relative pointers
+        inline void rel(uint32_t field, uint32_t target) {
+            put(field, static_cast<int32_t>(target - field));
+        }
+    };
+
+    inline std::string joint_name(uint32_t index) {
+        return "joint" + std::to_string(index);
+    }
+
+    // Stable pseudo random values so generated files do not change between runs
+    struct Random {
+        uint32_t state;
+
+        inline uint32_t next() noexcept {
+            state = state * 1664525u + 1013904223u;
+            return state >> 8;
+        }
+
+        inline float unit() noexcept {
+            return static_cast<float>(next() & 0xFFFF) / 65535.0f;
+        }
+    };
+
+    inline Quat rotation(float angle) noexcept {
+        return { 0.0f, std::sin(angle * 0.5f), 0.0f, std::cos(angle * 0.5f) };
+    }
+
+    // Inverse of QuantizedQuat::operator Quat
+    inline QuantizedQuat quantize(Quat const& q) noexcept {
+        float const c[4] = { q.x, q.y, q.z, q.w };
+        uint32_t maxIndex = 0;
+        for(uint32_t i = 1; i != 4; i++) {
+            if(std::abs(c[i]) > std::abs(c[maxIndex])) {
+                maxIndex = i;
+            }
+        }
+        auto const sign = c[maxIndex] < 0.0f ? -1.0f : 1.0f;
+        uint64_t bits = static_cast<uint64_t>(maxIndex) << 45;
+        int shift = 30;
+        for(uint32_t i = 0; i != 4; i++) {
+            if(i == maxIndex) {
+                continue;
+            }
+            auto const scaled = (c[i] * sign + 1.0f / std::sqrt(2.0f)) / std::sqrt(2.0f) * 32767.0f;
+            auto const value = static_cast<uint64_t>(std::clamp(std::lround(scaled), 0l, 32767l));
+            bits |= value << shift;
+            shift -= 15;
+        }
+        return { {
+            static_cast<uint16_t>(bits),
+            static_cast<uint16_t>(bits >> 16),
+            static_cast<uint16_t>(bits >> 32),
+        } };
+    }
+}
+
+std::vector<uint8_t> Rito::Bench::GenerateSkn(uint32_t vertexCount, uint32_t submeshCount, uint32_t jointCount) {
+    using namespace GenerateImpl;
+    submeshCount = std::max(submeshCount, 1u);
+    vertexCount = std::min(vertexCount, 0xFFFFu);
+    jointCount = std::clamp(jointCount, 1u, 256u);
+    auto const perSubmesh = std::max(vertexCount / submeshCount, 4u);
+    auto const width = std::max(static_cast<uint32_t>(std::sqrt(static_cast<float>(perSubmesh))), 2u);
+    auto const height = std::max(perSubmesh / width, 2u);
+    submeshCount = std::min(submeshCount, 0xFFFFu / (width * height));
+
+    Writer out;
+    out.write(uint32_t { 0x00112233u });
+    out.write(uint32_t { 0x10004u });
+    out.write(static_cast<int32_t>(submeshCount));
+    for(uint32_t s = 0; s != submeshCount; s++) {
+        char name[64] = {};
+        std::snprintf(name, sizeof(name), "submesh%u", s);
+        out.write(name);
+        auto const indexCount = (width - 1) * (height - 1) * 6;
+        out.write(static_cast<int32_t>(s * width * height));
+        out.write(static_cast<int32_t>(width * height));
+        out.write(static_cast<int32_t>(s * indexCount));
+        out.write(static_cast<int32_t>(indexCount));
+    }
+
+    auto const totalVertices = submeshCount * width * height;
+    auto const totalIndices = submeshCount * (width - 1) * (height - 1) * 6;
+    out.write(uint32_t { 0 });
+    out.write(static_cast<int32_t>(totalIndices));
+    out.write(static_cast<int32_t>(totalVertices));
+    out.write(int32_t { 52 });
+    out.write(uint32_t { 0 });
+    out.write(Box3D { { 0.0f, 0.0f, 0.0f }, { static_cast<float>(width), static_cast<float>(height), static_cast<float>(submeshCount) } });
+    out.write(Sphere { { width * 0.5f, height * 0.5f, submeshCount * 0.5f }, static_cast<float>(width + height + submeshCount) });
+
+    for(uint32_t s = 0; s != submeshCount; s++) {
+        auto const base = s * width * height;
+        for(uint32_t y = 0; y + 1 < height; y++) {
+            for(uint32_t x = 0; x + 1 < width; x++) {
+                auto const i = static_cast<uint16_t>(base + y * width + x);
+                for(auto const index: { i, uint16_t(i + width), uint16_t(i + 1), uint16_t(i + 1), uint16_t(i + width), uint16_t(i + width + 1) }) {
+                    out.write(index);
+                }
+            }
+        }
+    }
+
+    auto random = Random { 1 };
+    for(uint32_t s = 0; s != submeshCount; s++) {
+        for(uint32_t y = 0; y != height; y++) {
+            for(uint32_t x = 0; x != width; x++) {
+                out.write(Vec3 { static_cast<float>(x), static_cast<float>(y), static_cast<float>(s) + random.unit() * 0.1f });
+                std::array<uint8_t, 4> joints;
+                std::array<float, 4> weights;
+                auto sum = 0.0f;
+                for(size_t j = 0; j != 4; j++) {
+                    joints[j] = static_cast<uint8_t>((x + y + j * 7) % jointCount);
+                    weights[j] = j == 0 ? 1.0f : random.unit() * 0.5f;
+                    sum += weights[j];
+                }
+                for(auto& weight: weights) {
+                    weight /= sum;
+                }
+                out.write(joints);
+                out.write(weights);
+                out.write(Vec3 { 0.0f, 0.0f, 1.0f });
+                out.write(Vec2 { static_cast<float>(x) / width, static_cast<float>(y) / height });
+            }
+        }
+    }
+    out.write(Vec3 { 0.0f, 0.0f, 0.0f });
+    return std::move(out.data);
+}
+
+std::vector<uint8_t> Rito::Bench::GenerateSkl(uint32_t jointCount) {
+    using namespace GenerateImpl;
+    jointCount = std::clamp(jointCount, 1u, 0x7FFFu);
+    constexpr uint32_t headerSize = 64;
+    constexpr uint32_t jointSize = 100;
+    Writer out;
+    auto const header = out.alloc(headerSize);
+    auto const joints = out.alloc(jointSize * jointCount);
+    auto const indices = out.alloc(8 * jointCount);
+    auto const shaderJoints = out.alloc(2 * jointCount);
+    std::vector<uint32_t> names(jointCount);
+    for(uint32_t i = 0; i != jointCount; i++) {
+        names[i] = out.write_cstr(joint_name(i));
+    }
+    auto const assetName = out.write_cstr("bench.skl");
+
+    out.put(header + 0, static_cast<int32_t>(out.data.size()));
+    out.put(header + 4, uint32_t { 0x22FD4FC3u });
+    out.put(header + 8, uint32_t { 0 });
+    out.put(header + 12, uint16_t { 0 });
+    out.put(header + 14, static_cast<int16_t>(jointCount));
+    out.put(header + 16, static_cast<int32_t>(jointCount));
+    out.put(header + 20, static_cast<int32_t>(joints));
+    out.put(header + 24, static_cast<int32_t>(indices));
+    out.put(header + 28, static_cast<int32_t>(shaderJoints));
+    out.put(header + 36, static_cast<int32_t>(assetName));
+
+    for(uint32_t i = 0; i != jointCount; i++) {
+        auto const joint = joints + i * jointSize;
+        auto const parent = i == 0 ? -1 : static_cast<int32_t>((i - 1) / 2);
+        auto const local = Form3D { { 0.0f, 1.0f, 0.0f }, { 1.0f, 1.0f, 1.0f }, rotation(0.1f * static_cast<float>(i % 8)) };
+        auto const inverseRoot = Form3D { { 0.0f, -static_cast<float>(i), 0.0f }, { 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f, 0.0f, 1.0f } };
+        out.put(joint + 0, uint16_t { 0 });
+        out.put(joint + 2, static_cast<int16_t>(i));
+        out.put(joint + 4, static_cast<int16_t>(parent));
+        out.put(joint + 8, ElfHash(joint_name(i)));
+        out.put(joint + 12, 1.0f);
+        out.put(joint + 16, local);
+        out.put(joint + 56, inverseRoot);
+        out.rel(joint + 96, names[i]);
+
+        out.put(indices + i * 8, static_cast<int16_t>(i));
+        out.put(indices + i * 8 + 4, ElfHash(joint_name(i)));
+        out.put(shaderJoints + i * 2, static_cast<int16_t>(i));
+    }
+    return std::move(out.data);
+}
+
+std::vector<uint8_t> Rito::Bench::GenerateAnm(uint32_t version, uint32_t trackCount, uint32_t frameCount) {
+    using namespace GenerateImpl;
+    trackCount = std::max(trackCount, 1u);
+    frameCount = std::max(frameCount, 1u);
+    Writer out;
+    out.write_bytes("r3d2anmd");
+    out.write(version);
+    auto const frame_rotation = [](uint32_t t, uint32_t f) {
+        return rotation(0.01f * static_cast<float>(f) + 0.1f * static_cast<float>(t));
+    };
+    auto const frame_position = [](uint32_t t, uint32_t f) {
+        return Vec3 { 0.0f, 1.0f + 0.01f * static_cast<float>(f % 16), 0.001f * static_cast<float>(t) };
+    };
+
+    if(version == 3) {
+        out.write(uint32_t { 0 });
+        out.write(static_cast<int32_t>(trackCount));
+        out.write(static_cast<int32_t>(frameCount));
+        out.write(int32_t { 30 });
+        for(uint32_t t = 0; t != trackCount; t++) {
+            char name[32] = {};
+            std::snprintf(name, sizeof(name), "%s", joint_name(t).c_str());
+            out.write(name);
+            out.write(uint32_t { 0 });
+            for(uint32_t f = 0; f != frameCount; f++) {
+                out.write(frame_rotation(t, f));
+                out.write(frame_position(t, f));
+            }
+        }
+        return std::move(out.data);
+    }
+
+    // Offsets of new formats are relative to the resource header that follows magic and version
+    auto const base = static_cast<uint32_t>(out.data.size());
+    auto const header = out.alloc(64);
+    auto const at = [&](uint32_t offset) {
+        return static_cast<int32_t>(offset - base);
+    };
+    auto const frames = trackCount * frameCount;
+    // Positions are shared between frames, scales are all one, rotations are unique per frame
+    auto const vectorCount = std::min<uint32_t>(16 * trackCount + 1, 0xFFFF);
+    auto const quatCount = std::min<uint32_t>(frames, 0xFFFF);
+    auto const vectors = out.alloc(12 * vectorCount);
+    for(uint32_t v = 0; v + 1 < vectorCount; v++) {
+        out.put(vectors + v * 12, frame_position(v / 16, v % 16));
+    }
+    out.put(vectors + (vectorCount - 1) * 12, Vec3 { 1.0f, 1.0f, 1.0f });
+    auto const quatSize = version == 4 ? 16u : 6u;
+    auto const quats = out.alloc(quatSize * quatCount);
+    for(uint32_t q = 0; q != quatCount; q++) {
+        auto const value = frame_rotation(q % trackCount, q / trackCount);
+        if(version == 4) {
+            out.put(quats + q * quatSize, value);
+        } else {
+            out.put(quats + q * quatSize, quantize(value));
+        }
+    }
+    auto const frameSize = version == 4 ? 12u : 6u;
+    auto const frameData = out.alloc(frameSize * frames);
+    for(uint32_t f = 0; f != frameCount; f++) {
+        for(uint32_t t = 0; t != trackCount; t++) {
+            auto const index = f * trackCount + t;
+            auto const position = static_cast<uint16_t>(std::min((t * 16 + f % 16), vectorCount - 2));
+            auto frame = frameData + index * frameSize;
+            if(version == 4) {
+                out.put(frame, ElfHash(joint_name(t)));
+                frame += 4;
+            }
+            out.put(frame + 0, position);
+            out.put(frame + 2, static_cast<uint16_t>(vectorCount - 1));
+            out.put(frame + 4, static_cast<uint16_t>(index % quatCount));
+        }
+    }
+    uint32_t hashes = 0;
+    if(version != 4) {
+        hashes = out.alloc(4 * trackCount);
+        for(uint32_t t = 0; t != trackCount; t++) {
+            out.put(hashes + t * 4, ElfHash(joint_name(t)));
+        }
+    }
+    auto const assetName = out.write_cstr("bench.anm");
+
+    out.put(header + 0, static_cast<int32_t>(out.data.size() - base));
+    out.put(header + 4, uint32_t { 0xBE0794D3u });
+    out.put(header + 8, version);
+    out.put(header + 12, uint32_t { 0 });
+    out.put(header + 16, static_cast<int32_t>(trackCount));
+    out.put(header + 20, static_cast<int32_t>(frameCount));
+    out.put(header + 24, 1.0f / 30.0f);
+    out.put(header + 28, version == 4 ? int32_t { 0 } : at(hashes));
+    out.put(header + 32, at(assetName));
+    out.put(header + 36, int32_t { 0 });
+    out.put(header + 40, at(vectors));
+    out.put(header + 44, at(quats));
+    out.put(header + 48, at(frameData));
+    return std::move(out.data);
+}
+
+std::vector<uint8_t> Rito::Bench::GenerateMapGeo(uint32_t meshCount, uint32_t vertexCount) {
+    using namespace GenerateImpl;
+    meshCount = std::max(meshCount, 1u);
+    vertexCount = std::clamp(vertexCount, 4u, 0xFFFFu);
+    auto const width = std::max(static_cast<uint32_t>(std::sqrt(static_cast<float>(vertexCount))), 2u);
+    auto const height = std::max(vertexCount / width, 2u);
+    auto const indexCount = (width - 1) * (height - 1) * 6;
+
+    Writer out;
+    out.write_bytes("OEGM");
+    out.write(uint32_t { 6 });
+    out.write(uint8_t { 0 });
+    // One vertex layout: position, normal, texcoord
+    out.write(int32_t { 1 });
+    out.write(uint32_t { 0 });
+    out.write(uint32_t { 3 });
+    for(auto const& [name, format]: { std::pair { 0u, 2u }, std::pair { 1u, 2u }, std::pair { 5u, 1u } }) {
+        out.write(name);
+        out.write(format);
+    }
+    out.alloc(8 * 12, 1);
+
+    out.write(static_cast<int32_t>(meshCount));
+    for(uint32_t m = 0; m != meshCount; m++) {
+        out.write(static_cast<int32_t>(width * height * 32));
+        for(uint32_t y = 0; y != height; y++) {
+            for(uint32_t x = 0; x != width; x++) {
+                out.write(Vec3 { static_cast<float>(x), 0.0f, static_cast<float>(y) });
+                out.write(Vec3 { 0.0f, 1.0f, 0.0f });
+                out.write(Vec2 { static_cast<float>(x) / width, static_cast<float>(y) / height });
+            }
+        }
+    }
+    out.write(static_cast<int32_t>(meshCount));
+    for(uint32_t m = 0; m != meshCount; m++) {
+        out.write(static_cast<int32_t>(indexCount * 2));
+        for(uint32_t y = 0; y + 1 < height; y++) {
+            for(uint32_t x = 0; x + 1 < width; x++) {
+                auto const i = static_cast<uint16_t>(y * width + x);
+                for(auto const index: { i, uint16_t(i + width), uint16_t(i + 1), uint16_t(i + 1), uint16_t(i + width), uint16_t(i + width + 1) }) {
+                    out.write(index);
+                }
+            }
+        }
+    }
+
+    out.write(static_cast<int32_t>(meshCount));
+    for(uint32_t m = 0; m != meshCount; m++) {
+        out.write_string<int32_t>("mesh" + std::to_string(m));
+        out.write(width * height);
+        out.write(int32_t { 1 });
+        out.write(uint32_t { 0 });
+        out.write(m);
+        out.write(indexCount);
+        out.write(m);
+        // Two submeshes splitting the indices between materials
+        auto const half = indexCount / 6 / 2 * 6;
+        out.write(int32_t { 2 });
+        for(uint32_t s = 0; s != 2; s++) {
+            out.write(uint32_t { 0 });
+            out.write_string<int32_t>("material" + std::to_string((m + s) % 16));
+            out.write(s == 0 ? 0u : half);
+            out.write(s == 0 ? half : indexCount - half);
+            out.write(uint32_t { 0 });
+            out.write(width * height - 1);
+        }
+        out.write(uint8_t { 0 });
+        auto const offset = static_cast<float>(m % 64) * static_cast<float>(width);
+        out.write(Box3D { { offset, 0.0f, 0.0f }, { offset + width, 0.0f, static_cast<float>(height) } });
+        auto transform = Mtx44::identity();
+        transform[3][0] = offset;
+        out.write(transform);
+        out.write(uint8_t { 0 });
+        out.alloc(108, 1);
+        out.write_string<int32_t>("");
+        out.write(ColorF { 1.0f, 1.0f, 1.0f, 1.0f });
+    }
+    return std::move(out.data);
+}
+
+std::vector<uint8_t> Rito::Bench::GenerateBlend(uint32_t clipCount, uint32_t maskCount, uint32_t eventCount) {
+    using namespace GenerateImpl;
+    clipCount = std::max(clipCount, 1u);
+    constexpr uint32_t trackCount = 2;
+    auto random = Random { 5 };
+    Writer out;
+    auto const header = out.alloc(96);
+
+    auto const tracks = out.alloc(48 * trackCount);
+    for(uint32_t t = 0; t != trackCount; t++) {
+        auto const track = tracks + 48 * t;
+        out.put(track + 0, uint32_t { 48 });
+        out.put(track + 4, 1.0f);
+        out.put(track + 8, t);
+        out.put(track + 12, t);
+        auto const name = "track" + std::to_string(t);
+        std::memcpy(out.data.data() + track + 16, name.data(), name.size());
+    }
+
+    std::vector<uint32_t> masks;
+    for(uint32_t m = 0; m != maskCount; m++) {
+        constexpr uint32_t jointCount = 3;
+        auto const mask = out.alloc(40);
+        auto const weights = out.alloc(4 * jointCount);
+        auto const hashes = out.alloc(8 * jointCount);
+        out.put(mask + 0, uint32_t { 40 });
+        out.put(mask + 12, uint16_t { 1 });
+        out.put(mask + 14, static_cast<uint16_t>(jointCount));
+        out.put(mask + 16, 0x1000u + m);
+        out.put(mask + 20, static_cast<int32_t>(weights - mask));
+        out.put(mask + 24, static_cast<int32_t>(hashes - mask));
+        for(uint32_t j = 0; j != jointCount; j++) {
+            out.put(weights + 4 * j, 0.25f * static_cast<float>(j + 1));
+            out.put(hashes + 8 * j, static_cast<int32_t>(j));
+            out.put(hashes + 8 * j + 4, ElfHash(joint_name(j)));
+        }
+        masks.push_back(mask);
+    }
+
+    std::vector<uint32_t> events;
+    for(uint32_t e = 0; e != eventCount; e++) {
+        constexpr uint32_t count = 6;
+        auto const event = out.alloc(48);
+        out.put(event + 0, uint32_t { 48 });
+        out.put(event + 14, static_cast<uint16_t>(count));
+        out.put(event + 16, 0x2000u + e);
+        out.put(event + 36, static_cast<int32_t>(out.write_cstr("events" + std::to_string(e)) - event));
+        auto const array = out.alloc(4 * count);
+        out.put(event + 20, static_cast<int32_t>(array - event));
+        for(uint32_t k = 0; k != count; k++) {
+            auto const data = out.alloc(36);
+            auto const str = [&](uint32_t field, std::string const& value) {
+                out.put(data + field, static_cast<int32_t>(out.write_cstr(value) - data));
+            };
+            out.put(data + 0, uint32_t { 36 });
+            out.put(data + 4, k % 6);
+            out.put(data + 8, k);
+            out.put(data + 12, static_cast<float>(random.next() % 31));
+            str(16, "ev" + std::to_string(e) + "_" + std::to_string(k));
+            switch(k % 6) {
+            case 0:
+                str(20, "fx" + std::to_string(k));
+                str(24, "bone" + std::to_string(k));
+                str(28, "target" + std::to_string(k));
+                out.put(data + 32, 40.0f);
+                break;
+            case 1:
+                str(20, "snd" + std::to_string(k));
+                break;
+            case 2:
+                out.put(data + 20, 10.0f);
+                out.put(data + 24, uint32_t { 1 });
+                out.put(data + 28, uint32_t { 2 });
+                break;
+            case 3:
+                out.put(data + 20, 0.5f);
+                out.put(data + 24, 0.3f);
+                out.put(data + 28, 12.0f);
+                break;
+            case 4:
+                out.put(data + 20, 8.0f);
+                out.put(data + 24, uint16_t { 3 });
+                out.put(data + 26, uint16_t { 4 });
+                break;
+            default:
+                out.put(data + 20, 9.0f);
+                out.put(data + 24, uint32_t { 1 });
+                break;
+            }
+            out.put(array + 4 * k, static_cast<int32_t>(data - event));
+        }
+        events.push_back(event);
+    }
+
+    std::vector<uint32_t> clips;
+    auto const clip = [&](uint32_t uniqueID, std::string const& name, size_t dataSize) {
+        auto const result = out.alloc(20);
+        out.put(result + 0, uint32_t { 20 });
+        out.put(result + 8, uniqueID);
+        out.put(result + 12, static_cast<int32_t>(out.write_cstr(name) - result));
+        auto const data = out.alloc(dataSize);
+        out.put(result + 16, static_cast<int32_t>(data - result));
+        clips.push_back(result);
+        return data;
+    };
+    for(uint32_t i = 0; i != clipCount; i++) {
+        auto const data = clip(0x100 + i, "atomic" + std::to_string(i), 52);
+        out.put(data + 0, uint32_t { 1 });
+        out.put(data + 8, uint32_t { 30 });
+        out.put(data + 12, 1.0f / 30.0f);
+        out.put(data + 16, i);
+        if(eventCount) {
+            out.rel(data + 20, events[i % eventCount]);
+        }
+        if(maskCount && i % 2) {
+            out.rel(data + 24, masks[i % maskCount]);
+        }
+        out.rel(data + 28, tracks + 48 * (i % trackCount));
+        if(i == 0) {
+            auto const updater = out.alloc(16);
+            out.put(updater + 0, uint32_t { 16 });
+            out.put(updater + 8, uint16_t { 1 });
+            auto const array = out.alloc(4);
+            out.put(updater + 12, static_cast<int32_t>(array - updater));
+            auto const updaterData = out.alloc(16);
+            out.put(array, static_cast<int32_t>(updaterData - updater));
+            out.put(updaterData + 0, uint32_t { 16 });
+            out.put(updaterData + 4, uint16_t { 1 });
+            out.put(updaterData + 6, uint16_t { 2 });
+            out.put(updaterData + 8, uint8_t { 1 });
+            auto const processor = out.alloc(16);
+            out.put(processor + 0, uint32_t { 16 });
+            out.put(processor + 8, 2.0f);
+            out.put(processor + 12, 0.5f);
+            out.put(updaterData + 12, static_cast<int32_t>(processor - updaterData));
+            out.put(data + 32, static_cast<int32_t>(updater - data));
+        }
+        out.rel(data + 36, out.write_cstr("sync" + std::to_string(i % 2)));
+        out.put(data + 40, i % 2);
+    }
+
+    auto const n = std::min(clipCount, 4u);
+    auto data = clip(0x900, "selector", 12 + 8 * n);
+    out.put(data + 0, uint32_t { 2 });
+    out.put(data + 8, n);
+    for(uint32_t k = 0; k != n; k++) {
+        out.put(data + 12 + 8 * k, 0x100u + k);
+        out.put(data + 16 + 8 * k, 0.25f);
+    }
+    data = clip(0x901, "sequencer", 12 + 4 * n);
+    out.put(data + 0, uint32_t { 3 });
+    out.put(data + 4, uint32_t { 1 });
+    out.put(data + 8, n);
+    for(uint32_t k = 0; k != n; k++) {
+        out.put(data + 12 + 4 * k, 0x100u + k);
+    }
+    data = clip(0x902, "parallel", 12 + 4 * 2);
+    out.put(data + 0, uint32_t { 4 });
+    auto const flags = out.alloc(8);
+    out.put(flags, uint32_t { 1 });
+    out.put(data + 4, static_cast<int32_t>(flags - data));
+    out.put(data + 8, uint32_t { 2 });
+    out.put(data + 12, uint32_t { 0x900 });
+    out.put(data + 16, uint32_t { 0x901 });
+    data = clip(0x903, "parametric", 20 + 8 * n);
+    out.put(data + 0, uint32_t { 6 });
+    out.put(data + 4, n);
+    out.put(data + 8, uint32_t { 7 });
+    if(maskCount) {
+        out.rel(data + 12, masks[0]);
+    }
+    out.rel(data + 16, tracks);
+    for(uint32_t k = 0; k != n; k++) {
+        out.put(data + 20 + 8 * k, 0x100u + k);
+        out.put(data + 24 + 8 * k, static_cast<float>(k));
+    }
+    data = clip(0x904, "condbool", 32);
+    out.put(data + 0, uint32_t { 7 });
+    out.put(data + 4, uint32_t { 2 });
+    out.put(data + 8, uint32_t { 8 });
+    out.put(data + 12, uint8_t { 1 });
+    out.put(data + 16, uint32_t { 0x902 });
+    out.put(data + 20, uint8_t { 1 });
+    out.put(data + 24, uint32_t { 0x903 });
+    data = clip(0x905, "condfloat", 48);
+    out.put(data + 0, uint32_t { 8 });
+    out.put(data + 4, uint32_t { 2 });
+    out.put(data + 8, uint32_t { 9 });
+    for(uint32_t k = 0; k != 2; k++) {
+        out.put(data + 16 + 16 * k, 0x903u + k);
+        out.put(data + 20 + 16 * k, static_cast<float>(k));
+        out.put(data + 24 + 16 * k, 0.1f);
+        out.put(data + 28 + 16 * k, 0.1f);
+    }
+    data = clip(0x906, "multi", 4);
+    out.put(data + 0, uint32_t { 5 });
+
+    auto const pointers = [&](std::vector<uint32_t> const& items) {
+        auto const array = out.alloc(4 * std::max<size_t>(items.size(), 1));
+        for(size_t k = 0; k != items.size(); k++) {
+            out.put(static_cast<uint32_t>(array + 4 * k), static_cast<int32_t>(items[k] - array));
+        }
+        return array;
+    };
+    auto const clipArray = pointers(clips);
+    auto const maskArray = pointers(masks);
+    auto const eventArray = pointers(events);
+
+    auto const blendData = out.alloc(32);
+    out.put(blendData + 0, uint32_t { 1 });
+    out.put(blendData + 4, uint32_t { 2 });
+    out.put(blendData + 12, 0.2f);
+    out.put(blendData + 16, uint32_t { 2 });
+    out.put(blendData + 20, uint32_t { 1 });
+    out.put(blendData + 28, 0.3f);
+    auto const transition = out.alloc(12);
+    auto const transitionTo = out.alloc(8);
+    out.put(transition + 0, uint32_t { 5 });
+    out.put(transition + 4, uint32_t { 1 });
+    out.rel(transition + 8, transitionTo);
+    out.put(transitionTo + 0, uint32_t { 1 });
+    out.put(transitionTo + 4, uint32_t { 2 });
+    constexpr uint32_t animationCount = 3;
+    auto const animations = out.alloc(8 * animationCount);
+    for(uint32_t k = 0; k != animationCount; k++) {
+        out.put(animations + 8 * k, 0x5000u + k);
+        out.rel(animations + 8 * k + 4, out.write_cstr("ASSETS/anim" + std::to_string(k) + ".anm"));
+    }
+
+    out.put(header + 0, uint32_t { 96 });
+    out.put(header + 12, static_cast<uint32_t>(clips.size()));
+    out.put(header + 16, uint32_t { 2 });
+    out.put(header + 20, uint32_t { 1 });
+    out.put(header + 24, trackCount);
+    out.put(header + 32, maskCount);
+    out.put(header + 36, eventCount);
+    out.rel(header + 48, blendData);
+    out.rel(header + 52, transition);
+    out.rel(header + 56, tracks);
+    out.rel(header + 60, clipArray);
+    if(maskCount) {
+        out.rel(header + 64, maskArray);
+    }
+    if(eventCount) {
+        out.rel(header + 68, eventArray);
+    }
+    out.put(header + 76, animationCount);
+    out.rel(header + 80, animations);
+    out.put(header + 84, uint32_t { 0x77 });
+    out.rel(header + 88, out.write_cstr("ASSETS/bench.skl"));
+
+    Writer file;
+    file.write_bytes("r3d2blnd");
+    file.write(uint32_t { 1 });
+    file.data.insert(file.data.end(), out.data.begin(), out.data.end());
+    return std::move(file.data);
+}
+
+std::vector<uint8_t> Rito::Bench::GenerateBin(uint32_t entryCount) {
+    using namespace GenerateImpl;
+    constexpr std::string_view classes[] = { "SkinCharacterDataProperties", "StaticMaterialDef", "VfxSystemDefinitionData" };
+    auto const path = [](uint32_t index) {
+        return "Characters/Bench/Entry" + std::to_string(index);
+    };
+
+    Writer entries;
+    std::vector<uint32_t> types;
+    for(uint32_t i = 0; i != entryCount; i++) {
+        types.push_back(Fnv1aHash(classes[i % 3]));
+        auto const length = entries.alloc(4, 1);
+        auto const start = static_cast<uint32_t>(entries.data.size());
+        entries.write(Fnv1aHash(path(i)));
+        entries.write(uint16_t { 15 });
+        auto const field = [&](std::string_view name, uint8_t type) {
+            entries.write(Fnv1aHash(name));
+            entries.write(type);
+        };
+        // Size of a container counts from right after the size field
+        auto const sized = [&](auto&& body) {
+            auto const size = entries.alloc(4, 1);
+            body();
+            entries.put(size, static_cast<int32_t>(entries.data.size() - size - 4));
+        };
+        auto const fields = [&](uint16_t count, auto&& body) {
+            sized([&] {
+                entries.write(count);
+                body();
+            });
+        };
+
+        field("mName", 16);
+        entries.write_string<uint16_t>(path(i));
+        field("mValue", 10);
+        entries.write(static_cast<float>(i) * 0.5f);
+        field("mCount", 7);
+        entries.write(i);
+        field("mFlag", 1);
+        entries.write(uint8_t { 1 });
+        field("mPos", 12);
+        entries.write(Vec3 { 1.0f, 2.0f, 3.0f });
+        field("mColor", 15);
+        entries.write(ColorB { 1, 2, 3, 4 });
+        field("mList", 0x80);
+        entries.write(uint8_t { 10 });
+        sized([&] {
+            entries.write(uint32_t { 8 });
+            for(uint32_t k = 0; k != 8; k++) {
+                entries.write(static_cast<float>(k));
+            }
+        });
+        field("mEmbed", 0x83);
+        entries.write(Fnv1aHash("Inner"));
+        fields(1, [&] {
+            field("mInner", 6);
+            entries.write(-static_cast<int32_t>(i));
+        });
+        field("mPtr", 0x82);
+        entries.write(uint32_t { 0 });
+        field("mPtr2", 0x82);
+        entries.write(Fnv1aHash("Inner2"));
+        fields(1, [&] {
+            field("mText", 16);
+            entries.write_string<uint16_t>("hello");
+        });
+        field("mOpt", 0x85);
+        entries.write(uint8_t { 17 });
+        entries.write(uint8_t { 1 });
+        entries.write(Fnv1aHash("opt"));
+        field("mMap", 0x86);
+        entries.write(uint8_t { 17 });
+        entries.write(uint8_t { 16 });
+        sized([&] {
+            entries.write(uint32_t { 2 });
+            for(uint32_t k = 1; k != 3; k++) {
+                entries.write(k);
+                entries.write_string<uint16_t>(std::string(1, static_cast<char>('a' + k)));
+            }
+        });
+        field("mLink", 0x84);
+        entries.write(Fnv1aHash(path((i + 1) % entryCount)));
+        field("mFile", 18);
+        entries.write(XXHash64(path(i)));
+        field("mBit", 0x87);
+        entries.write(uint8_t { 1 });
+        entries.put(length, static_cast<int32_t>(entries.data.size() - start));
+    }
+
+    Writer out;
+    out.write_bytes("PROP");
+    out.write(uint32_t { 3 });
+    out.write(uint32_t { 1 });
+    out.write_string<uint16_t>("DATA/Characters/Bench/Shared.bin");
+    out.write(entryCount);
+    for(auto const type: types) {
+        out.write(type);
+    }
+    out.data.insert(out.data.end(), entries.data.begin(), entries.data.end());
+    return std::move(out.data);
+}
@@ -0,0 +1,21 @@
+#ifndef RITO_BENCH_GENERATE_HPP
+#define RITO_BENCH_GENERATE_HPP
+#include <cinttypes>
+#include <vector>
+
+// Synthetic but valid assets, output only depends on the requested sizes
+namespace Rito::Bench {
+    // Grid per submesh, vertexCount is capped to what 16-bit indices can address
+    std::vector<uint8_t> GenerateSkn(uint32_t vertexCount, uint32_t submeshCount, uint32_t jointCount);
+    // Binary tree of joints
+    std::vector<uint8_t> GenerateSkl(uint32_t jointCount);
+    // Legacy 3, new 4 or new 5, tracks are named by the joint names of GenerateSkl
+    std::vector<uint8_t> GenerateAnm(uint32_t version, uint32_t trackCount, uint32_t frameCount);
+    std::vector<uint8_t> GenerateMapGeo(uint32_t meshCount, uint32_t vertexCount);
+    // Every clip kind, clipCount atomic clips plus one of each composite
+    std::vector<uint8_t> GenerateBlend(uint32_t clipCount, uint32_t maskCount, uint32_t eventCount);
+    // Entries of three classes with every value type
+    std::vector<uint8_t> GenerateBin(uint32_t entryCount);
+}
+
+#endif // RITO_BENCH_GENERATE_HPP
@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include "generate.hpp"
+#include "rito2assimp.hpp"
+#include "rito/animation.hpp"
+#include "rito/bin.hpp"
+#include "rito/blend.hpp"
+#include "rito/blendview.hpp"
+#include "rito/mapgeo.hpp"
+#include "rito/simpleskin.hpp"
+#include "rito/skeleton.hpp"
+
+namespace fs = std::filesystem;
+
+// Every allocation made through global new is counted, sizes are kept in a header in front of the block
+namespace Rito::BenchImpl {
+    constexpr size_t headerSize = alignof(std::max_align_t);
+    std::atomic<uint64_t> allocations = 0;
+    std::atomic<int64_t> liveBytes = 0;
+    std::atomic<int64_t> peakBytes = 0;
+
+    inline void* allocate(size_t size) noexcept {
+        auto const block = static_cast<char*>(std::malloc(size + headerSize));
+        if(!block) {
+            return nullptr;
+        }
+        *reinterpret_cast<size_t*>(block) = size;
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        auto const live = liveBytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed) + static_cast<int64_t>(size);
+        for(auto peak = peakBytes.load(std::memory_order_relaxed); live > peak;) {
+            if(peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        return block + headerSize;
+    }
+
+    inline void* allocate_or_throw(size_t size) {
+        if(auto const result = allocate(size); result) {
+            return result;
+        }
+        throw std::bad_alloc();
+    }
+
+    inline void deallocate(void* ptr) noexcept {
+        if(!ptr) {
+            return;
+        }
+        auto const block = static_cast<char*>(ptr) - headerSize;
+        liveBytes.fetch_sub(static_cast<int64_t>(*reinterpret_cast<size_t*>(block)), std::memory_order_relaxed);
+        std::free(block);
+    }
+}
+
+void* operator new(size_t size) {
+    return Rito::BenchImpl::allocate_or_throw(size);
+}
+
+void* operator new[](size_t size) {
+    return Rito::BenchImpl::allocate_or_throw(size);
+}
+
+void* operator new(size_t size, std::nothrow_t const&) noexcept {
+    return Rito::BenchImpl::allocate(size);
+}
+
+void* operator new[](size_t size, std::nothrow_t const&) noexcept {
+    return Rito::BenchImpl::allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    Rito::BenchImpl::deallocate(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    Rito::BenchImpl::deallocate(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    Rito::BenchImpl::deallocate(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    Rito::BenchImpl::deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::nothrow_t const&) noexcept {
+    Rito::BenchImpl::deallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::nothrow_t const&) noexcept {
+    Rito::BenchImpl::deallocate(ptr);
+}
+
+namespace Rito::BenchImpl {
+    struct Options {
+        double scale = 1.0;
+        uint32_t iterations = 10;
+        fs::path directory = fs::temp_directory_path() / "ritofiles_bench";
+        std::string filter;
+    };
+
+    struct Case {
+        std::string name;
+        fs::path path;
+        // Object counted for throughput
+        char const* unit;
+        // Loads path once and returns how many units it holds
+        std::function<size_t(char const* path)> load;
+    };
+
+    // Resident set in bytes from /proc/self/status, field is VmRSS or VmHWM, 0 when unavailable
+    inline size_t rss(std::string_view field) {
+        std::ifstream status("/proc/self/status");
+        for(std::string line; std::getline(status, line);) {
+            if(line.starts_with(field) && line.size() > field.size() && line[field.size()] == ':') {
+                return std::strtoull(line.c_str() + field.size() + 1, nullptr, 10) * 1024;
+            }
+        }
+        return 0;
+    }
+
+    // Starts a new VmHWM high water mark at the current resident set, only Linux can do this.
+    // Elsewhere the process wide peak would include every earlier case so no rss is reported.
+    // Free heap pages are handed back first, otherwise loads reuse pages an earlier load left resident.
+    inline bool reset_peak_rss() {
+#ifdef __linux__
+#ifdef __GLIBC__
+        malloc_trim(0);
+#endif
+        std::ofstream clearRefs("/proc/self/clear_refs");
+        clearRefs << "5";
+        clearRefs.close();
+        return clearRefs.good() && rss("VmHWM") != 0;
+#else
+        return false;
+#endif
+    }
+
+    inline uint32_t scaled(Options const& options, double count) noexcept {
+        return static_cast<uint32_t>(std::max(1.0, count * options.scale));
+    }
+
+    inline void write(fs::path const& path, std::vector<uint8_t> const& data) {
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<char const*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if(!out) {
+            throw std::runtime_error("Failed to write " + path.string());
+        }
+    }
+
+    inline std::vector<Case> make_cases(Options const& options) {
+        auto const& dir = options.directory;
+        fs::create_directories(dir);
+        auto const joints = std::min(scaled(options, 256), 0x7FFFu);
+        write(dir / "bench.skn", Bench::GenerateSkn(scaled(options, 60000), 4, std::min(joints, 256u)));
+        write(dir / "bench.skl", Bench::GenerateSkl(joints));
+        for(uint32_t version = 3; version <= 5; version++) {
+            write(dir / ("bench_v" + std::to_string(version) + ".anm"), Bench::GenerateAnm(version, 128, scaled(options, 600)));
+        }
+        write(dir / "bench.mapgeo", Bench::GenerateMapGeo(scaled(options, 400), 1024));
+        write(dir / "bench.blnd", Bench::GenerateBlend(scaled(options, 5000), scaled(options, 200), scaled(options, 200)));
+        write(dir / "bench.bin", Bench::GenerateBin(scaled(options, 20000)));
+
+        auto const animation = [](char const* path) {
+            auto const anm = Animation { File { path } };
+            size_t keys = 0;
+            for(auto const& track: anm.tracks) {
+                keys += track.rotations.size();
+            }
+            return keys;
+        };
+        auto const skn = (dir / "bench.skn").string();
+        auto const skl = (dir / "bench.skl").string();
+        return {
+            { "skn", dir / "bench.skn", "vertices", [](char const* path) {
+                  return SimpleSkin { File { path } }.vtxPositions.size();
+              } },
+            { "skn view", dir / "bench.skn", "vertices", [](char const* path) {
+                  return static_cast<size_t>(SimpleSkinView { File { path } }.vertexCount);
+              } },
+            { "skl", dir / "bench.skl", "joints", [](char const* path) {
+                  return Skeleton { File { path } }.joints.size();
+              } },
+            { "anm v3", dir / "bench_v3.anm", "keys", animation },
+            { "anm v4", dir / "bench_v4.anm", "keys", animation },
+            { "anm v5", dir / "bench_v5.anm", "keys", animation },
+            { "mapgeo", dir / "bench.mapgeo", "meshes", [](char const* path) {
+                  return MapGeo { File { path } }.meshInfos.size();
+              } },
+            { "mapgeo lazy", dir / "bench.mapgeo", "meshes", [](char const* path) {
+                  return MapGeo { File { path }, lazy }.meshInfos.size();
+              } },
+            { "blnd", dir / "bench.blnd", "clips", [](char const* path) {
+                  auto blend = Blend {};
+                  blend.read(File { path });
+                  return blend.clips.size();
+              } },
+            { "blnd view", dir / "bench.blnd", "clips", [](char const* path) {
+                  return BlendView { File { path } }.clips().size();
+              } },
+            { "bin", dir / "bench.bin", "entries", [](char const* path) {
+                  return Bin { File { path } }.entries.size();
+              } },
+            { "bin scan", dir / "bench.bin", "entries", [](char const* path) {
+                  auto const file = File { path };
+                  auto scanner = BinScanner { file, { Fnv1aHash("SkinCharacterDataProperties") } };
+                  size_t count = 0;
+                  while(scanner.next()) {
+                      count++;
+                  }
+                  return count;
+              } },
+            { "ImportSkin", dir / "bench.skn", "vertices", [skl](char const* path) {
+                  return static_cast<size_t>(ImportSkin(path, skl.c_str())->mMeshes[0]->mNumVertices);
+              } },
+        };
+    }
+
+    inline void run(Case const& test, Options const& options) {
+        auto const path = test.path.string();
+        auto const bytes = static_cast<double>(fs::file_size(test.path));
+        test.load(path.c_str());
+
+        std::vector<double> seconds;
+        size_t objects = 0;
+        uint64_t allocationCount = 0;
+        int64_t peak = 0;
+        for(uint32_t i = 0; i != options.iterations; i++) {
+            auto const allocationsBefore = allocations.load();
+            peakBytes = liveBytes.load();
+            auto const baseline = peakBytes.load();
+            auto const start = std::chrono::steady_clock::now();
+            objects = test.load(path.c_str());
+            auto const end = std::chrono::steady_clock::now();
+            seconds.push_back(std::chrono::duration<double>(end - start).count());
+            allocationCount = allocations.load() - allocationsBefore;
+            peak = std::max(peak, peakBytes.load() - baseline);
+        }
+        // Resident set growth of one more untimed load, trimming the heap first would skew the timings above
+        char resident[16] = "-";
+        if(reset_peak_rss()) {
+            auto const residentBefore = rss("VmRSS");
+            test.load(path.c_str());
+            auto const highWater = rss("VmHWM");
+            auto const growth = highWater - std::min(highWater, residentBefore);
+            std::snprintf(resident, sizeof(resident), "%.1f", static_cast<double>(growth) / (1024.0 * 1024.0));
+        }
+        std::sort(seconds.begin(), seconds.end());
+        auto const median = seconds[seconds.size() / 2];
+        std::printf("%-12s %9.2f %9.3f %9.1f %12.0f %-8s %9llu %9.2f %9s\n",
+                    test.name.c_str(),
+                    bytes / (1024.0 * 1024.0),
+                    median * 1000.0,
+                    bytes / (1024.0 * 1024.0) / median,
+                    static_cast<double>(objects) / median,
+                    test.unit,
+                    static_cast<unsigned long long>(allocationCount),
+                    static_cast<double>(peak) / (1024.0 * 1024.0),
+                    resident);
+    }
+
+    inline Options parse(int argc, char** argv) {
+        Options options;
+        for(int i = 1; i < argc; i++) {
+            auto const arg = std::string_view { argv[i] };
+            auto const value = [&](std::string_view name) {
+                return arg.substr(name.size());
+            };
+            if(arg.starts_with("--scale=")) {
+                options.scale = std::stod(std::string { value("--scale=") });
+            } else if(arg.starts_with("--iterations=")) {
+                options.iterations = std::max(1u, static_cast<uint32_t>(std::stoul(std::string { value("--iterations=") })));
+            } else if(arg.starts_with("--dir=")) {
+                options.directory = value("--dir=");
+            } else if(arg.starts_with("--filter=")) {
+                options.filter = value("--filter=");
+            } else {
+                std::printf("usage: ritofiles_bench [--scale=1] [--iterations=10] [--dir=<tmp>/ritofiles_bench] [--filter=name]\n");
+                std::exit(arg == "--help" ? 0 : 1);
+            }
+        }
+        return options;
+    }
+}
+
+int main(int argc, char** argv) {
+    using namespace Rito::BenchImpl;
+    auto const options = parse(argc, argv);
+    auto const cases = make_cases(options);
+    std::printf("%-12s %9s %9s %9s %12s %-8s %9s %9s %9s\n",
+                "parser", "file MB", "ms", "MB/s", "objects/s", "object", "allocs", "heap MB", "rss MB");
+    for(auto const& test: cases) {
+        if(test.name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+        try {
+            run(test, options);
+        } catch(std::exception const& error) {
+            std::printf("%-12s failed: %s\n", test.name.c_str(), error.what());
+        }
+    }
+    return 0;
+}
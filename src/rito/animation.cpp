@@ -26,14 +26,14 @@ namespace Rito::AnimationImpl::Legacy {
         auto const header = file.get<Header>();
         anm.tickDuration = 1.f / header.frameRate;
 
-        auto const tracks = file.get<std::vector<Track>>(header.numTracks);
-        for(auto const& rawTrack: tracks) {
+        for(int32_t t = 0; t < header.numTracks; t++) {
+            auto const rawTrack = file.get<Track>();
             auto frames = file.get<std::vector<Frame>>(header.numFrames);
             auto& track = anm.tracks.emplace_back();
             track.positions.reserve(frames.size());
             track.scales.reserve(frames.size());
             track.rotations.reserve(frames.size());
-            track.name = rawTrack.name;
+            track.name = anm.strings->intern(rawTrack.name);
             track.boneHash = ElfHash(rawTrack.name);
             for(auto const& frame: frames) {
                 track.positions.push_back(frame.position);
@@ -85,7 +85,6 @@ namespace Rito::AnimationImpl::NewV4 {
                 auto const frameOffset = framesOffset[frameIdx];
                 auto const frame = file.get<Frame>(frameOffset);
                 track.boneHash = frame.boneHash;
-                track.boneHash = frame.boneHash;
                 track.positions.push_back(file.get<Vec3>(vectorsOffset[frame.posIndx]));
                 track.scales.push_back(file.get<Vec3>(vectorsOffset[frame.scaleIndx]));
                 track.rotations.push_back(file.get<Quat>(quatsOffset[frame.quatIndx]).normalize());
@@ -131,7 +130,7 @@ namespace Rito::AnimationImpl::NewV5 {
         auto const vectorsOffset = header->vectors + header;
         auto const quatsOffset = header->quats + header;
         for(int32_t t = 0; t < header->numTracks; t++) {
-            auto track = anm.tracks.emplace_back();
+            auto& track = anm.tracks.emplace_back();
             track.positions.reserve(static_cast<size_t>(header->numFrames));
             track.scales.reserve(static_cast<size_t>(header->numFrames));
             track.rotations.reserve(static_cast<size_t>(header->numFrames));
@@ -139,7 +138,7 @@ namespace Rito::AnimationImpl::NewV5 {
                 auto const frameIdx = f * header->numTracks + t;
                 auto const frameOffset = framesOffset[frameIdx];
                 auto const frame = file.get<Frame>(frameOffset);
-                track.boneHash = file.get<uint32_t>(hashesOffset[frameIdx]);
+                track.boneHash = file.get<uint32_t>(hashesOffset[t]);
                 track.positions.push_back(file.get<Vec3>(vectorsOffset[frame.posIndx]));
                 track.scales.push_back(file.get<Vec3>(vectorsOffset[frame.scaleIndx]));
                 auto const quat_quantized = file.get<QuantizedQuat>(quatsOffset[frame.quatIndx]);
@@ -190,7 +189,8 @@ namespace Rito::AnimationImpl::NewCompressed {
     }
 }
 
-Rito::Animation::Animation(File const& file) {
+Rito::Animation::Animation(File const& file, std::shared_ptr<StringPool> strings)
+    : strings(StringPool::shared_or_new(std::move(strings))) {
     struct Header {
         std::array<char, 8> magic;
         uint32_t version;
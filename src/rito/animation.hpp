@@ -10,14 +10,17 @@ namespace Rito {
             std::vector<Vec3> positions;
             std::vector<Vec3> scales;
             std::vector<Quat> rotations;
-            std::string name;
+            InternedString name;
             uint32_t boneHash;
         };
         std::vector<Track> tracks;
         float tickDuration;
         std::string assetName;
+        // Pool of the track names
+        std::shared_ptr<StringPool> strings;
 
-        Animation(File const&);
+        // Names go into strings, a new pool when it is null
+        Animation(File const&, std::shared_ptr<StringPool> strings = {});
     };
 }
 
@@ -1,24 +1,414 @@
+#include <cstring>
+#include <algorithm>
 #include "bin.hpp"
+#include "memory.hpp"
 
 using namespace Rito;
 
-void Rito::Bin::read(File const& file) {
-    struct {
-        std::array<char, 4> magic;
-        uint32_t version;
-    } header;
+namespace Rito::BinImpl {
+    using Type = Bin::Type;
+    using Value = Bin::Value;
 
-    file_assert(file.read(header));
-    file_assert((header.magic == std::array{'P', 'R', 'O', 'P'}));
-    if(header.version >= 2u) {
-        uint32_t linkedFileCount = 0;
-        file_assert(file.read(linkedFileCount));
-        for(uint32_t i = 0; i < linkedFileCount; i++) {
-            uint16_t linkedFileNameLength;
-            file_assert(file.read(linkedFileNameLength));
-            auto& linkedFileName = linkedFiles.emplace_back();
-            linkedFileName.resize(linkedFileNameLength);
-            file_assert(file.read(linkedFileName));
+    inline Mem::Reader reader(Bin const& bin, int32_t offset, int32_t size) {
+        file_assert(offset >= 0 && size >= 0 && size <= static_cast<int32_t>(bin.data.size()) - offset);
+        return { bin.data.data(), offset + size, offset };
+    }
+
+    inline int32_t primitive_size(Type type) noexcept {
+        switch(type) {
+        case Type::None: return 0;
+        case Type::Bool: return 1;
+        case Type::I8: return 1;
+        case Type::U8: return 1;
+        case Type::I16: return 2;
+        case Type::U16: return 2;
+        case Type::I32: return 4;
+        case Type::U32: return 4;
+        case Type::I64: return 8;
+        case Type::U64: return 8;
+        case Type::F32: return 4;
+        case Type::Vec2: return 8;
+        case Type::Vec3: return 12;
+        case Type::Vec4: return 16;
+        case Type::Mtx44: return 64;
+        case Type::Rgba: return 4;
+        case Type::Hash: return 4;
+        case Type::File: return 8;
+        case Type::Link: return 4;
+        case Type::Flag: return 1;
+        default: return -1;
+        }
+    }
+
+    // Skips over one value of type, container bodies are skipped through their size field
+    inline Value read_value(Mem::Reader& reader, Type type) {
+        auto const start = reader.tell();
+        if(auto const size = primitive_size(type); size >= 0) {
+            reader.seek_cur(size);
+        } else {
+            switch(type) {
+            case Type::String:
+                reader.seek_cur(reader.get<uint16_t>());
+                break;
+            case Type::List:
+            case Type::List2:
+                reader.seek_cur(1);
+                reader.seek_cur(reader.get<int32_t>());
+                break;
+            case Type::Pointer:
+                if(reader.get<uint32_t>() != 0) {
+                    reader.seek_cur(reader.get<int32_t>());
+                }
+                break;
+            case Type::Embed:
+                reader.seek_cur(4);
+                reader.seek_cur(reader.get<int32_t>());
+                break;
+            case Type::Option: {
+                auto const valueType = reader.get<Type>();
+                if(reader.get<uint8_t>() != 0) {
+                    read_value(reader, valueType);
+                }
+                break;
+            }
+            case Type::Map:
+                reader.seek_cur(2);
+                reader.seek_cur(reader.get<int32_t>());
+                break;
+            default:
+                file_assert(!"Unknown bin value type");
+            }
+        }
+        return { type, start, reader.tell() - start };
+    }
+
+    // Field list shared by entries, pointers and embeds
+    inline Bin::Object read_fields(Mem::Reader& reader, uint32_t classHash) {
+        auto object = Bin::Object { classHash, {}, {} };
+        auto const count = reader.get<uint16_t>();
+        object.fields.reserve(count);
+        for(uint16_t i = 0; i != count; i++) {
+            auto const nameHash = reader.get<uint32_t>();
+            auto const type = reader.get<Type>();
+            object.fields.push_back({ nameHash, read_value(reader, type) });
+        }
+        file_assert(reader.tell() == reader.end);
+        object.index = HashIndex<>(object.fields, [](Bin::Field const& field) {
+            return field.nameHash;
+        });
+        return object;
+    }
+
+    // Magic, version and linked files, shared by Bin and BinScanner as both readers have the same api
+    template<typename R>
+    inline std::vector<uint32_t> read_header(R& reader, Bin& bin) {
+        auto magic = reader.template get<std::array<char, 4>>();
+        if(magic == std::array{'P', 'T', 'C', 'H'}) {
+            bin.isPatch = true;
+            reader.seek_cur(8);
+            magic = reader.template get<std::array<char, 4>>();
+        }
+        file_assert((magic == std::array{'P', 'R', 'O', 'P'}));
+        bin.version = reader.template get<uint32_t>();
+
+        if(bin.version >= 2u) {
+            auto const linkedFileCount = reader.template get<uint32_t>();
+            for(uint32_t i = 0; i < linkedFileCount; i++) {
+                bin.linkedFiles.push_back(reader.template get<std::string>(size_prefix<uint16_t>));
+            }
+        }
+
+        auto const entryCount = reader.template get<int32_t>();
+        file_assert(entryCount >= 0);
+        std::vector<uint32_t> entryTypes;
+        reader.read(entryTypes, entryCount);
+        return entryTypes;
+    }
+
+    template<typename T>
+    inline bool matches(Type type) noexcept {
+        if constexpr(std::is_same_v<T, bool>) {
+            return type == Type::Bool || type == Type::Flag;
+        } else if constexpr(std::is_same_v<T, int8_t>) {
+            return type == Type::I8;
+        } else if constexpr(std::is_same_v<T, uint8_t>) {
+            return type == Type::U8;
+        } else if constexpr(std::is_same_v<T, int16_t>) {
+            return type == Type::I16;
+        } else if constexpr(std::is_same_v<T, uint16_t>) {
+            return type == Type::U16;
+        } else if constexpr(std::is_same_v<T, int32_t>) {
+            return type == Type::I32;
+        } else if constexpr(std::is_same_v<T, uint32_t>) {
+            return type == Type::U32 || type == Type::Hash || type == Type::Link;
+        } else if constexpr(std::is_same_v<T, int64_t>) {
+            return type == Type::I64;
+        } else if constexpr(std::is_same_v<T, uint64_t>) {
+            return type == Type::U64 || type == Type::File;
+        } else if constexpr(std::is_same_v<T, float>) {
+            return type == Type::F32;
+        } else if constexpr(std::is_same_v<T, Vec2>) {
+            return type == Type::Vec2;
+        } else if constexpr(std::is_same_v<T, Vec3>) {
+            return type == Type::Vec3;
+        } else if constexpr(std::is_same_v<T, Vec4>) {
+            return type == Type::Vec4;
+        } else if constexpr(std::is_same_v<T, Mtx44>) {
+            return type == Type::Mtx44;
+        } else if constexpr(std::is_same_v<T, ColorB>) {
+            return type == Type::Rgba;
+        } else {
+            static_assert(std::is_same_v<T, void>, "Not a bin primitive");
+        }
+    }
+}
+
+Bin::Value const* Bin::Object::find(uint32_t nameHash) const noexcept {
+    auto const index = this->index.find(nameHash);
+    return index != HashIndex<>::none ? &fields[index].value : nullptr;
+}
+
+Bin::Bin(File const& file) {
+    read(file);
+}
+
+void Bin::read(File const& file) {
+    using namespace Rito::BinImpl;
+    // Nothing of a previous read may survive, read_header and the loops below only append
+    *this = Bin {};
+    file.seek_end(0);
+    auto const dataSize = file.tell();
+    file.seek_beg(0);
+    file.read(data, dataSize);
+    auto reader = Mem::Reader { data.data(), dataSize, 0 };
+
+    auto const entryTypes = read_header(reader, *this);
+    entries.reserve(entryTypes.size());
+    for(auto const typeHash: entryTypes) {
+        auto const length = reader.get<int32_t>();
+        auto const start = reader.tell();
+        file_assert(length >= 6);
+        auto const pathHash = reader.get<uint32_t>();
+        entries.push_back({ typeHash, pathHash, reader.tell(), length - 4 });
+        reader.seek_beg(start);
+        reader.seek_cur(length);
+    }
+    entryIndex = HashIndex<>(entries, [](Entry const& entry) {
+        return entry.pathHash;
+    });
+    objects.reset(entries.size());
+
+    if(isPatch && version >= 3u) {
+        auto const patchCount = reader.get<uint32_t>();
+        for(uint32_t i = 0; i < patchCount; i++) {
+            auto& patch = patches.emplace_back();
+            patch.pathHash = reader.get<uint32_t>();
+            auto const length = reader.get<int32_t>();
+            auto const start = reader.tell();
+            auto const type = reader.get<Type>();
+            patch.path = reader.get<std::string>(size_prefix<uint16_t>);
+            patch.value = read_value(reader, type);
+            file_assert(reader.tell() - start == length);
+        }
+    }
+}
+
+Bin::Entry const* Bin::find(uint32_t pathHash) const noexcept {
+    auto const index = entryIndex.find(pathHash);
+    return index != HashIndex<>::none ? &entries[index] : nullptr;
+}
+
+Bin::ObjectCache::ObjectCache(ObjectCache const& other) {
+    reset(other.size);
+}
+
+Bin::ObjectCache::ObjectCache(ObjectCache&& other) noexcept
+    : slots(std::move(other.slots)), size(std::exchange(other.size, 0)) {}
+
+Bin::ObjectCache& Bin::ObjectCache::operator=(ObjectCache const& other) {
+    if(this != &other) {
+        reset(other.size);
+    }
+    return *this;
+}
+
+Bin::ObjectCache& Bin::ObjectCache::operator=(ObjectCache&& other) noexcept {
+    if(this != &other) {
+        reset(0);
+        slots = std::move(other.slots);
+        size = std::exchange(other.size, 0);
+    }
+    return *this;
+}
+
+Bin::ObjectCache::~ObjectCache() {
+    reset(0);
+}
+
+void Bin::ObjectCache::reset(size_t count) {
+    for(size_t i = 0; i != size; i++) {
+        delete slots[i].load();
+    }
+    slots.reset(count ? new std::atomic<Object const*>[count] {} : nullptr);
+    size = count;
+}
+
+Bin::Object const& Bin::object(Entry const& entry) const {
+    // Through uintptr_t, comparing pointers into different arrays is unspecified
+    auto const address = reinterpret_cast<uintptr_t>(&entry);
+    auto const first = reinterpret_cast<uintptr_t>(entries.data());
+    auto index = address >= first ? (address - first) / sizeof(Entry) : entries.size();
+    if(index >= entries.size() || (address - first) % sizeof(Entry) != 0) {
+        // Copy of an entry, find the one it was taken from
+        index = entryIndex.find(entry.pathHash);
+        file_assert(index != HashIndex<>::none && entries[index].offset == entry.offset);
+    }
+    file_assert(index < objects.size);
+    auto& slot = objects.slots[index];
+    if(auto const cached = slot.load(std::memory_order_acquire); cached) {
+        return *cached;
+    }
+    auto reader = BinImpl::reader(*this, entry.offset, entry.size);
+    auto decoded = std::make_unique<Object>(BinImpl::read_fields(reader, entry.typeHash));
+    Object const* expected = nullptr;
+    if(slot.compare_exchange_strong(expected, decoded.get(), std::memory_order_acq_rel)) {
+        return *decoded.release();
+    }
+    // Another thread decoded it first
+    return *expected;
+}
+
+Bin::Object Bin::object(Value const& value) const {
+    file_assert(value.type == Type::Pointer || value.type == Type::Embed);
+    auto reader = BinImpl::reader(*this, value.offset, value.size);
+    auto const classHash = reader.get<uint32_t>();
+    if(classHash == 0 && value.type == Type::Pointer) {
+        return {};
+    }
+    auto const size = reader.get<int32_t>();
+    file_assert(size == reader.end - reader.tell());
+    return BinImpl::read_fields(reader, classHash);
+}
+
+std::vector<Bin::Value> Bin::items(Value const& value) const {
+    auto reader = BinImpl::reader(*this, value.offset, value.size);
+    std::vector<Value> result;
+    if(value.type == Type::Option) {
+        auto const valueType = reader.get<Type>();
+        if(reader.get<uint8_t>() != 0) {
+            result.push_back(BinImpl::read_value(reader, valueType));
         }
+        return result;
     }
+    file_assert(value.type == Type::List || value.type == Type::List2);
+    auto const valueType = reader.get<Type>();
+    reader.seek_cur(4);
+    auto const count = reader.get<uint32_t>();
+    result.reserve(std::min(count, static_cast<uint32_t>(reader.end - reader.tell())));
+    for(uint32_t i = 0; i != count; i++) {
+        result.push_back(BinImpl::read_value(reader, valueType));
+    }
+    file_assert(reader.tell() == reader.end);
+    return result;
+}
+
+std::vector<std::pair<Bin::Value, Bin::Value>> Bin::pairs(Value const& value) const {
+    file_assert(value.type == Type::Map);
+    auto reader = BinImpl::reader(*this, value.offset, value.size);
+    auto const keyType = reader.get<Type>();
+    auto const valueType = reader.get<Type>();
+    reader.seek_cur(4);
+    auto const count = reader.get<uint32_t>();
+    std::vector<std::pair<Value, Value>> result;
+    result.reserve(std::min(count, static_cast<uint32_t>(reader.end - reader.tell())));
+    for(uint32_t i = 0; i != count; i++) {
+        auto const key = BinImpl::read_value(reader, keyType);
+        result.emplace_back(key, BinImpl::read_value(reader, valueType));
+    }
+    file_assert(reader.tell() == reader.end);
+    return result;
+}
+
+BinScanner::BinScanner(File const& file, std::vector<uint32_t> typeHashes)
+    : file(file), typeHashes(std::move(typeHashes)) {
+    std::sort(this->typeHashes.begin(), this->typeHashes.end());
+    file.seek_end(0);
+    end = file.tell();
+    file.seek_beg(0);
+    entryTypes = BinImpl::read_header(file, bin);
+    pos = file.tell();
+    windowStart = pos;
+    bin.entries.reserve(1);
+}
+
+uint8_t const* BinScanner::fetch(int32_t size) {
+    file_assert(size >= 0 && size <= end - pos);
+    auto const windowEnd = windowStart + static_cast<int32_t>(window.size());
+    if(pos < windowStart || size > windowEnd - pos) {
+        file.seek_beg(pos);
+        file.read(window, std::min(std::max(size, windowSize), end - pos));
+        windowStart = pos;
+    }
+    return window.data() + (pos - windowStart);
 }
+
+Bin::Entry const* BinScanner::next() {
+    while(nextEntry != entryTypes.size()) {
+        auto const typeHash = entryTypes[nextEntry++];
+        int32_t length;
+        memcpy(&length, fetch(4), 4);
+        pos += 4;
+        file_assert(length >= 6 && length <= end - pos);
+        if(!typeHashes.empty() && !std::binary_search(typeHashes.begin(), typeHashes.end(), typeHash)) {
+            pos += length;
+            continue;
+        }
+        auto const body = fetch(length);
+        uint32_t pathHash;
+        memcpy(&pathHash, body, 4);
+        bin.data.assign(body + 4, body + length);
+        pos += length;
+        bin.entries.clear();
+        bin.entries.push_back({ typeHash, pathHash, 0, length - 4 });
+        bin.entryIndex.clear();
+        bin.entryIndex.insert(pathHash, 0);
+        bin.objects.reset(1);
+        return &bin.entries.back();
+    }
+    return nullptr;
+}
+
+template<typename T>
+T Bin::get(Value const& value) const {
+    auto reader = BinImpl::reader(*this, value.offset, value.size);
+    if constexpr(std::is_same_v<T, std::string_view>) {
+        file_assert(value.type == Type::String);
+        auto const size = reader.get<uint16_t>();
+        file_assert(size == reader.end - reader.tell());
+        return { reinterpret_cast<char const*>(data.data() + reader.tell()), size };
+    } else {
+        file_assert(BinImpl::matches<T>(value.type));
+        if constexpr(std::is_same_v<T, bool>) {
+            return reader.get<uint8_t>() != 0;
+        } else {
+            return reader.get<T>();
+        }
+    }
+}
+
+template bool Bin::get<bool>(Value const&) const;
+template int8_t Bin::get<int8_t>(Value const&) const;
+template uint8_t Bin::get<uint8_t>(Value const&) const;
+template int16_t Bin::get<int16_t>(Value const&) const;
+template uint16_t Bin::get<uint16_t>(Value const&) const;
+template int32_t Bin::get<int32_t>(Value const&) const;
+template uint32_t Bin::get<uint32_t>(Value const&) const;
+template int64_t Bin::get<int64_t>(Value const&) const;
+template uint64_t Bin::get<uint64_t>(Value const&) const;
+template float Bin::get<float>(Value const&) const;
+template Vec2 Bin::get<Vec2>(Value const&) const;
+template Vec3 Bin::get<Vec3>(Value const&) const;
+template Vec4 Bin::get<Vec4>(Value const&) const;
+template Mtx44 Bin::get<Mtx44>(Value const&) const;
+template ColorB Bin::get<ColorB>(Value const&) const;
+template std::string_view Bin::get<std::string_view>(Value const&) const;
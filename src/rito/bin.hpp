@@ -1,12 +1,161 @@
 #ifndef RITO_BIN_HPP
 #define RITO_BIN_HPP
+#include <cinttypes>
+#include <atomic>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
 #include "file.hpp"
 #include "types.hpp"
+#include "hashindex.hpp"
 
 namespace Rito {
+    // PROP property bin. Reading only walks the entry table, values are decoded on demand out of data.
     struct Bin {
+        enum class Type : uint8_t {
+            None = 0,
+            Bool = 1,
+            I8 = 2,
+            U8 = 3,
+            I16 = 4,
+            U16 = 5,
+            I32 = 6,
+            U32 = 7,
+            I64 = 8,
+            U64 = 9,
+            F32 = 10,
+            Vec2 = 11,
+            Vec3 = 12,
+            Vec4 = 13,
+            Mtx44 = 14,
+            Rgba = 15,
+            String = 16,
+            Hash = 17,
+            File = 18,
+            List = 0x80,
+            List2 = 0x81,
+            Pointer = 0x82,
+            Embed = 0x83,
+            Link = 0x84,
+            Option = 0x85,
+            Map = 0x86,
+            Flag = 0x87,
+        };
+
+        // Encoded bytes of one value inside data
+        struct Value {
+            Type type = Type::None;
+            int32_t offset = {};
+            int32_t size = {};
+        };
+
+        struct Field {
+            uint32_t nameHash;
+            Value value;
+        };
+
+        // Fields of an entry, pointer or embed indexed by name hash
+        struct Object {
+            uint32_t classHash = {};
+            std::vector<Field> fields;
+            HashIndex<> index;
+
+            // Nullptr when there is no such field
+            Value const* find(uint32_t nameHash) const noexcept;
+        };
+
+        struct Entry {
+            uint32_t typeHash;
+            uint32_t pathHash;
+            // Offset of the field count
+            int32_t offset;
+            int32_t size;
+        };
+
+        struct Patch {
+            uint32_t pathHash;
+            std::string path;
+            Value value;
+        };
+
+        bool isPatch = {};
+        uint32_t version = {};
         std::vector<std::string> linkedFiles;
-        void read(File const& file) RITO_FILE_NOEXCEPT;
+        std::vector<Entry> entries;
+        std::vector<Patch> patches;
+        // pathHash to index into entries
+        HashIndex<> entryIndex;
+        std::vector<uint8_t> data;
+
+        Bin() noexcept = default;
+        Bin(File const& file);
+
+        void read(File const& file);
+
+        // Nullptr when there is no such entry
+        Entry const* find(uint32_t pathHash) const noexcept;
+
+        // Decoded on first use and kept until the bin is read again, safe to call from several threads
+        Object const& object(Entry const& entry) const;
+        // Pointer or Embed, null pointers give an empty object. Decoded on every call, keep the result around
+        // instead of calling this again for each field
+        Object object(Value const& value) const;
+        // Elements of List, List2 or Option
+        std::vector<Value> items(Value const& value) const;
+        // Key value pairs of Map
+        std::vector<std::pair<Value, Value>> pairs(Value const& value) const;
+
+        // Primitive value, T must match the value type:
+        // bool for Bool and Flag, uint32_t also for Hash and Link, uint64_t also for File,
+        // ColorB for Rgba and std::string_view into data for String
+        template<typename T>
+        T get(Value const& value) const;
+    private:
+        friend struct BinScanner;
+
+        // One lazily decoded object per entry, copies of a bin start with an empty cache
+        struct ObjectCache {
+            std::unique_ptr<std::atomic<Object const*>[]> slots;
+            size_t size = {};
+
+            ObjectCache() noexcept = default;
+            ObjectCache(ObjectCache const& other);
+            ObjectCache(ObjectCache&& other) noexcept;
+            ObjectCache& operator=(ObjectCache const& other);
+            ObjectCache& operator=(ObjectCache&& other) noexcept;
+            ~ObjectCache();
+
+            void reset(size_t count);
+        };
+        mutable ObjectCache objects;
+    };
+
+    // Pull style walk over the entry table straight from the file through a fixed size read window.
+    // Entries whose type hash is not in typeHashes are stepped over without copying their body,
+    // bodies larger than the window are never read at all. An empty typeHashes accepts every entry.
+    // Patches are not visited.
+    struct BinScanner {
+        File const& file;
+        std::vector<uint32_t> typeHashes;
+        // Header and linked files, entries and data only hold the current entry
+        Bin bin;
+
+        BinScanner(File const& file, std::vector<uint32_t> typeHashes = {});
+
+        // Next accepted entry, valid until the following call, nullptr after the last one
+        Bin::Entry const* next();
+    private:
+        static constexpr int32_t windowSize = 64 * 1024;
+        std::vector<uint32_t> entryTypes;
+        size_t nextEntry = {};
+        std::vector<uint8_t> window;
+        int32_t windowStart = {};
+        int32_t pos = {};
+        int32_t end = {};
+
+        // Makes [pos, pos + size) available in window
+        uint8_t const* fetch(int32_t size);
     };
 }
 
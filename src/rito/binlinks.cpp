@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <filesystem>
+#include "binlinks.hpp"
+#include "parallel.hpp"
+
+using namespace Rito;
+
+namespace Rito::BinLinksImpl {
+    inline std::string normalize(std::string path) {
+        for(auto& c: path) {
+            if(c == '\\') {
+                c = '/';
+            } else if(c >= 'A' && c <= 'Z') {
+                c = static_cast<char>(c - 'A' + 'a');
+            }
+        }
+        return path;
+    }
+
+    inline std::string join(std::string const& directory, std::string const& path) {
+        if(directory.empty() || directory.back() == '/' || directory.back() == '\\') {
+            return directory + path;
+        }
+        return directory + '/' + path;
+    }
+
+    // File to open for path: spelled as given with forward slashes, else all lower case as extracted trees often are
+    inline std::string locate(std::string const& directory, std::string const& path) {
+        auto given = path;
+        std::replace(given.begin(), given.end(), '\\', '/');
+        auto exact = join(directory, given);
+        if(std::filesystem::is_regular_file(exact)) {
+            return exact;
+        }
+        auto lower = join(directory, normalize(path));
+        return std::filesystem::is_regular_file(lower) ? lower : exact;
+    }
+
+    // Tarjan's strongly connected components, iterative so that long link chains can not overflow the stack.
+    // Components come out with every node after the nodes it links to.
+    inline void sort_components(BinLinks& links) {
+        constexpr auto none = ~uint32_t{};
+        auto const count = links.nodes.size();
+        std::vector<uint32_t> indices(count, none);
+        std::vector<uint32_t> lowLinks(count);
+        std::vector<bool> onStack(count);
+        std::vector<uint32_t> stack;
+        std::vector<std::pair<uint32_t, uint32_t>> calls;
+        uint32_t counter = 0;
+
+        for(uint32_t root = 0; root != count; root++) {
+            if(indices[root] != none) {
+                continue;
+            }
+            calls.push_back({ root, 0 });
+            while(!calls.empty()) {
+                auto& [node, edge] = calls.back();
+                if(edge == 0) {
+                    indices[node] = lowLinks[node] = counter++;
+                    stack.push_back(node);
+                    onStack[node] = true;
+                }
+                auto const& out = links.nodes[node].links;
+                if(edge != out.size()) {
+                    auto const next = out[edge++];
+                    if(indices[next] == none) {
+                        calls.push_back({ next, 0 });
+                    } else if(onStack[next]) {
+                        lowLinks[node] = std::min(lowLinks[node], indices[next]);
+                    }
+                    continue;
+                }
+                auto const done = node;
+                calls.pop_back();
+                if(!calls.empty()) {
+                    auto const parent = calls.back().first;
+                    lowLinks[parent] = std::min(lowLinks[parent], lowLinks[done]);
+                }
+                if(lowLinks[done] != indices[done]) {
+                    continue;
+                }
+                auto const begin = links.order.size();
+                uint32_t member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    onStack[member] = false;
+                    links.order.push_back(member);
+                } while(member != done);
+                auto const& selfLinks = links.nodes[done].links;
+                auto const size = links.order.size() - begin;
+                if(size > 1 || std::find(selfLinks.begin(), selfLinks.end(), done) != selfLinks.end()) {
+                    links.cycles.emplace_back(links.order.begin() + static_cast<ptrdiff_t>(begin), links.order.end());
+                }
+            }
+        }
+    }
+}
+
+std::shared_ptr<Bin const> BinCache::load(std::string const& path) {
+    auto const key = BinLinksImpl::normalize(path);
+    std::shared_ptr<Slot> slot;
+    {
+        auto const guard = std::lock_guard(lock);
+        auto& result = slots[key];
+        if(!result) {
+            result = std::make_shared<Slot>();
+        }
+        slot = result;
+    }
+    std::call_once(slot->once, [&] {
+        if(std::filesystem::is_regular_file(path)) {
+            slot->bin = std::make_shared<Bin const>(File { path.c_str() });
+        }
+    });
+    return slot->bin;
+}
+
+size_t BinCache::size() const {
+    auto const guard = std::lock_guard(lock);
+    return slots.size();
+}
+
+BinLinks::BinLinks(std::string const& directory, std::vector<std::string> const& roots, BinCache& cache) {
+    using namespace Rito::BinLinksImpl;
+    // Normalized path only identifies the node, files are opened by their original spelling first
+    // so that case sensitive file systems still find them
+    auto add = [&](std::string const& path) {
+        auto const [it, inserted] = byPath.try_emplace(normalize(path), static_cast<uint32_t>(nodes.size()));
+        if(inserted) {
+            nodes.push_back({ path, {}, {} });
+        }
+        return it->second;
+    };
+
+    for(auto const& root: roots) {
+        add(root);
+    }
+    for(size_t begin = 0; begin != nodes.size();) {
+        auto const end = nodes.size();
+        parallel_for(end - begin, [&](size_t i) {
+            auto& node = nodes[begin + i];
+            node.bin = cache.load(locate(directory, node.path));
+        });
+        for(auto i = begin; i != end; i++) {
+            if(!nodes[i].bin) {
+                continue;
+            }
+            for(auto const& linked: nodes[i].bin->linkedFiles) {
+                auto const index = add(linked);
+                nodes[i].links.push_back(index);
+            }
+        }
+        begin = end;
+    }
+
+    order.reserve(nodes.size());
+    sort_components(*this);
+}
+
+BinLinks::Node const* BinLinks::find(std::string const& path) const {
+    auto const found = byPath.find(BinLinksImpl::normalize(path));
+    return found != byPath.end() ? &nodes[found->second] : nullptr;
+}
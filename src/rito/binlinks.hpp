@@ -0,0 +1,54 @@
+#ifndef RITO_BINLINKS_HPP
+#define RITO_BINLINKS_HPP
+#include <cinttypes>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "bin.hpp"
+
+namespace Rito {
+    // Parsed bins shared between resolves and threads, every path is read at most once
+    struct BinCache {
+        // Nullptr when the file does not exist, parse errors are rethrown to every caller
+        std::shared_ptr<Bin const> load(std::string const& path);
+        size_t size() const;
+    private:
+        struct Slot {
+            std::once_flag once;
+            std::shared_ptr<Bin const> bin;
+        };
+        mutable std::mutex lock;
+        std::unordered_map<std::string, std::shared_ptr<Slot>> slots;
+    };
+
+    // Dependency graph of bins following linkedFiles, loaded level by level with each level in parallel
+    struct BinLinks {
+        struct Node {
+            // Relative to directory, spelled as in the first root or linkedFiles entry naming it
+            std::string path;
+            // Nullptr when the file does not exist
+            std::shared_ptr<Bin const> bin;
+            // Indices into nodes of linked files
+            std::vector<uint32_t> links;
+        };
+        // Roots come first in the given order
+        std::vector<Node> nodes;
+        // Every node after the nodes it links to, except for links inside a cycle
+        std::vector<uint32_t> order;
+        // Groups of nodes that link back to themselves
+        std::vector<std::vector<uint32_t>> cycles;
+
+        // Roots and linked files are looked up relative to directory
+        BinLinks(std::string const& directory, std::vector<std::string> const& roots, BinCache& cache);
+
+        // Nullptr when path was not reached, case and slash direction are ignored
+        Node const* find(std::string const& path) const;
+    private:
+        // Lower case path with forward slashes to index into nodes
+        std::unordered_map<std::string, uint32_t> byPath;
+    };
+}
+
+#endif // RITO_BINLINKS_HPP
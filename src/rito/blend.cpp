@@ -1,283 +1,7 @@
 #include "blend.hpp"
-#include "memory.hpp"
+#include "blendview.hpp"
 
 using namespace Rito;
-namespace Rito::BlendImpl {
-    namespace new_v1 {
-        using namespace Rito::Mem;
-        using Rito::Mem::FlexArr;
-        using Rito::Mem::AbsPtr;
-        using Rito::Mem::RelPtr;
-        using Rito::Mem::AbsPtrArr;
-        using Rito::Mem::RelPtrArr;
-
-        struct RawPath {
-            uint32_t hash;
-            RelPtr<char> path;
-        };
-
-        struct RawBlendData {
-            uint32_t fromAnimId;
-            uint32_t toAnimId;
-            uint32_t blendFlags;
-            float blendTime;
-        };
-
-        struct RawTransitionClip {
-            struct To {
-                uint32_t toAnimId;
-                uint32_t transitionAnimId;
-            };
-            uint32_t fromAnimID;
-            uint32_t numTransitions;
-            RelPtr<To> transitions;
-        };
-
-        struct RawTrack : BaseResource {
-            float blendWeight;
-            uint32_t blendMode;
-            uint32_t index;
-            std::array<char, 32> name;
-        };
-
-        struct RawMask : BaseResource {
-            struct RawJointHash {
-                int32_t weightID;
-                uint32_t jointHash;
-            };
-            struct RawJointIndex {
-                int32_t weightID;
-                uint32_t jointHash;
-            };
-            uint32_t formatToken;
-            uint32_t version;
-            uint16_t flags;
-            uint16_t numElements;
-            uint32_t uniqueID;
-            AbsPtr<float> weights;
-            AbsPtr<RawJointHash> jointHashes;
-            AbsPtr<RawJointIndex> jointIndices;
-            std::array<uint32_t, 2> extBuffer;
-        };
-
-        struct RawEvent : BaseResource {
-            struct RawEventHash {
-                uint32_t dataID;
-                uint32_t nameHash;
-            };
-            struct RawEventFrame {
-                uint32_t dataID;
-                float frame;
-            };
-            struct RawEventData : BaseResource {
-                enum class Type : uint32_t {
-                    Particle = 0x0,
-                    Sound = 0x1,
-                    SubmeshVisibility = 0x2,
-                    Fade = 0x3,
-                    JointSnap = 0x4,
-                    EnableLookAt = 0x5,
-                };
-                Type type;
-                uint32_t flags;
-                float frame;
-                AbsPtr<char> name;
-                union {
-                    struct {
-                        AbsPtr<char> effectName;
-                        AbsPtr<char> boneName;
-                        AbsPtr<char> targetBoneName;
-                        float endFrame;
-                    } particle;
-                    struct {
-                        AbsPtr<char> soundName;
-                    } sound;
-                    struct {
-                        float endFrame;
-                        uint32_t showSubmeshHash;
-                        uint32_t hideSubmeshHash;
-                    } submeshVisibility;
-                    struct {
-                        float timeToFade;
-                        float targeAlpha;
-                        float endFrame;
-                    } fade;
-                    struct {
-                        float endFrame;
-                        uint16_t jointToOverrideIndex;
-                        uint16_t jointToSnapToIndex;
-                    } jointSnap;
-                    struct {
-                        float endFrame;
-                        uint32_t enableLookAt;
-                        uint32_t lockCurrentValues;
-                    } enableLookAt;
-                } data;
-            };
-            uint32_t formatToken;
-            uint32_t version;
-            uint16_t flags;
-            uint16_t numEvents;
-            uint32_t uniqueID;
-            AbsPtrArr<RawEventData> eventsData;
-            AbsPtr<RawEventData> eventData;
-            AbsPtr<RawEventHash> eventHashes;
-            AbsPtr<RawEventFrame> eventFrames;
-            AbsPtr<char> name;
-            std::array<uint32_t, 2> extBuffer;
-        };
-
-        struct RawClip : BaseResource {
-            struct RawUpdater : BaseResource {
-                struct RawUpdaterData : BaseResource {
-                    struct RawProcessor : BaseResource {
-                        uint16_t type;
-                        uint16_t pad;
-                        union {
-                            struct {
-                                float nultiplier;
-                                float increment;
-                            } linearTransform;
-                        } data;
-                    };
-                    uint16_t inputType;
-                    uint16_t outputType;
-                    uint8_t numTransforms;
-                    uint8_t pad;
-                    AbsPtr<RawProcessor> processor;
-                };
-                uint32_t version;
-                uint16_t numUpdaters;
-                uint16_t pad;
-                AbsPtrArr<RawUpdaterData> updaters;
-            };
-
-            struct RawClipData {
-                enum class Type : uint32_t {
-                    Invalid,
-                    Atomic,
-                    Selector,
-                    Sequencer,
-                    Parallel,
-                    MultiChildClip,
-                    Parametric,
-                    ConditionBool,
-                    ConditionFloat,
-                };
-                Type type;
-                union {
-                    struct {
-                        uint32_t startTick;
-                        uint32_t endTick;
-                        float tickDuration;
-                        uint32_t animIndex;
-                        RelPtr<RawEvent> event; // ptr
-                        RelPtr<RawMask> mask; // ptr
-                        RelPtr<RawTrack> track; // ptr
-                        AbsPtr<RawUpdater> updater;
-                        RelPtr<char> syncGroupName;
-                        uint32_t syncGroup;
-                        std::array<uint32_t, 2> extBuffer;
-                    } atomic; // TODO 1
-                    struct {
-                        struct Entry {
-                            uint32_t clipID;
-                            float probability;
-                        };
-                        uint32_t trackIndex;
-                        uint32_t numPairs;
-                        FlexArr<Entry> entries;
-                    } selector;
-                    struct {
-                        struct Entry {
-                            uint32_t clipID; // children?
-                        };
-                        uint32_t trackIndex;
-                        uint32_t numPairs;
-                        FlexArr<Entry> entries;
-                    } sequencer;
-                    struct {
-                        struct Entry {
-                            uint32_t clipID; // children?
-                        };
-                        AbsPtr<uint32_t> clipFlags;
-                        uint32_t numClips;
-                        FlexArr<Entry> entries;
-                    } parallel;
-                    struct {
-                    } multiChild;
-                    struct {
-                        struct Entry {
-                            uint32_t clipID;
-                            float value;
-                        };
-                        uint32_t numPairs;
-                        uint32_t updaterType;
-                        RelPtr<RawMask> mask;
-                        RelPtr<RawTrack> track;
-                        FlexArr<Entry> entries;
-                    } parametric;
-                    struct {
-                        struct Entry {
-                            uint32_t clipID;
-                            bool value;
-                            uint8_t pad[3];
-                        };
-                        uint32_t numPairs;
-                        uint32_t updaterType;
-                        bool changeAnimationMidPlay;
-                        uint8_t pad[3];
-                        FlexArr<Entry> entries;
-                    } conditionBool;
-                    struct {
-                        struct Entry {
-                            uint32_t clipID;
-                            float value;
-                            float holdAnimationToHigher;
-                            float holdAnimationToLower;
-                        };
-                        uint32_t numPairs;
-                        uint32_t updaterType;
-                        bool changeAnimationMidPlay;
-                        uint8_t pad[3];
-                        FlexArr<Entry> entries;
-                    } conditionFloat;
-                } data;
-            };
-            uint16_t flags;
-            uint16_t pad;
-            uint32_t uniqueID;
-            AbsPtr<char> name;
-            AbsPtr<RawClipData> data;
-        };
-
-        struct Header : BaseResource {
-            uint32_t formatToken;
-            uint32_t version;
-            uint32_t numClips;
-            uint32_t numBlends;
-            uint32_t numTransitionClips;
-            uint32_t numTracks;
-            uint32_t numAnimData;
-            uint32_t numMasks;
-            uint32_t numEvents;
-            bool useCascadeBlend;
-            uint8_t pad[3];
-            float cascadeBlendValue;
-            RelPtr<RawBlendData> blendData;
-            RelPtr<RawTransitionClip> transitionClips;
-            RelPtr<RawTrack> blendTracks;
-            RelPtrArr<RawClip> clips;
-            RelPtrArr<RawMask> masks;
-            RelPtrArr<RawEvent> events;
-            uint32_t animsData;
-            uint32_t animNameCount;
-            RelPtr<RawPath> animNamesOffset;
-            RawPath skeleton;
-            std::array<uint32_t, 1> extBuffer;
-        };
-    }
-}
 
 void Blend::read(File const& file) {
     struct Header {
@@ -295,7 +19,6 @@ void Blend::read(File const& file) {
 }
 
 void Blend::read_v1(File const& file) {
-    using namespace Rito::BlendImpl::new_v1;
     auto const oldPos = file.tell();
     file.seek_end(0);
     auto const dataSize = file.tell() - oldPos;
@@ -303,21 +26,19 @@ void Blend::read_v1(File const& file) {
 
     std::vector<uint8_t> data{};
     file.read(data, dataSize);
-    Header const& header = *reinterpret_cast<Header const*>(data.data());
-    file_assert(header.version == 0);
+    read(BlendView { std::move(data) });
+}
 
-    if(auto skeletonPathPtr = header.skeleton.path.get(); skeletonPathPtr) {
-       skeletonPath = skeletonPathPtr;
-    }
+void Blend::read(BlendView const& view) {
+    skeletonPath = view.skeleton_path();
 
-    animationNames.reserve(header.animNameCount);
-    for(uint32_t i = 0; i < header.animNameCount; i++) {
-        animationNames.push_back(header.animNamesOffset.get(i)->path.get());
+    animationNames.reserve(view.animation_names().size());
+    for(auto const& path: view.animation_names()) {
+        animationNames.emplace_back(BlendView::name(path));
     }
 
-    blendData.reserve(header.numBlends);
-    for(uint32_t i = 0; i < header.numBlends; i++) {
-        auto const& rawBlendData = *header.blendData.get(i);
+    blendData.reserve(view.blend_data().size());
+    for(auto const& rawBlendData: view.blend_data()) {
         blendData.push_back(BlendData {
                                 rawBlendData.fromAnimId,
                                 rawBlendData.toAnimId,
@@ -326,79 +47,73 @@ void Blend::read_v1(File const& file) {
                             });
     }
 
-    transitionClips.reserve(header.numTransitionClips);
-    for(uint32_t i = 0; i < header.numTransitionClips; i++) {
-        auto const& raw = *header.transitionClips.get(i);
+    transitionClips.reserve(view.transition_clips().size());
+    for(auto const& raw: view.transition_clips()) {
         auto& result = transitionClips.emplace_back();
         result.fromAnimID = raw.fromAnimID;
-        result.transitions.resize(raw.numTransitions);
-        for(uint32_t j = 0; j < raw.numTransitions; j++) {
-            auto const& rawTransition = *raw.transitions.get(j);
-            result.transitions[j] = {
-                rawTransition.toAnimId,
-                rawTransition.transitionAnimId
-            };
+        result.transitions.reserve(raw.numTransitions);
+        for(auto const& rawTransition: BlendView::transitions(raw)) {
+            result.transitions.push_back({
+                                             rawTransition.toAnimId,
+                                             rawTransition.transitionAnimId
+                                         });
         }
     }
 
-    tracks.reserve(header.numTracks);
-    for(uint32_t i = 0; i < header.numTracks; i++) {
-        auto const& rawTrack = *header.blendTracks.get(i);
+    tracks.reserve(view.tracks().size());
+    for(auto const& rawTrack: view.tracks()) {
         tracks.push_back({
                              rawTrack.blendWeight,
                              rawTrack.blendMode,
                              rawTrack.index,
-                             rawTrack.name.data()
+                             std::string { BlendView::name(rawTrack) }
                          });
     }
 
-    masks.reserve(header.numMasks);
-    for(uint32_t i = 0; i < header.numMasks; i++) {
-        auto const& rawMask = *header.masks.get(i);
+    masks.reserve(view.masks().size());
+    for(auto const& rawMask: view.masks()) {
         auto& mask = masks.emplace_back();
         mask.flags = rawMask.flags;
         mask.uniqueID = rawMask.uniqueID;
         mask.joints.reserve(rawMask.numElements);
+        auto const jointHashes = BlendView::joint_hashes(rawMask);
+        auto const weights = BlendView::weights(rawMask);
         for(uint32_t j = 0; j < rawMask.numElements; j++) {
-            auto const& rawJointHash = *rawMask.jointHashes.get(rawMask, j);
-            auto const& weight = *rawMask.weights.get(rawMask, j);
             mask.joints.push_back({
-                                      rawJointHash.jointHash,
-                                      weight
+                                      jointHashes[j].jointHash,
+                                      weights[j]
                                   });
         }
     }
 
-    eventLists.reserve(header.numEvents);
-    for(uint32_t i = 0; i < header.numEvents; i++) {
-        auto const& rawEvent = *header.events.get(i);
+    eventLists.reserve(view.events().size());
+    for(auto const& rawEvent: view.events()) {
         auto& eventList = eventLists.emplace_back();
         eventList.flags = rawEvent.flags;
         eventList.uniqueID = rawEvent.uniqueID;
-        eventList.name = rawEvent.name.get(rawEvent);
+        eventList.name = BlendView::name(rawEvent);
         eventList.eventsData.reserve(rawEvent.numEvents);
-        for(uint32_t j = 0; j < rawEvent.numEvents; j++) {
-            auto const& raw = *rawEvent.eventsData.get(rawEvent, j);
-            using Type = RawEvent::RawEventData::Type;
+        for(auto const& raw: BlendView::events_data(rawEvent)) {
+            using Type = BlendView::EventData::Type;
             auto eventBase = Event::EventBase {
                 raw.flags,
                 raw.frame,
-                raw.name.get(raw)
+                std::string { BlendView::name(raw) }
             };
             switch(raw.type) {
             case Type::Particle:
                 eventList.eventsData.push_back(Event::EventParticle {
                                                    eventBase,
-                                                   raw.data.particle.effectName.get(raw),
-                                                   raw.data.particle.boneName.get(raw),
-                                                   raw.data.particle.targetBoneName.get(raw),
+                                                   std::string { BlendView::str(raw.data.particle.effectName.get(raw)) },
+                                                   std::string { BlendView::str(raw.data.particle.boneName.get(raw)) },
+                                                   std::string { BlendView::str(raw.data.particle.targetBoneName.get(raw)) },
                                                    raw.data.particle.endFrame
                                                });
                 break;
             case Type::Sound:
                 eventList.eventsData.push_back(Event::EventSoundName {
                                                    eventBase,
-                                                   raw.data.sound.soundName.get(raw),
+                                                   std::string { BlendView::str(raw.data.sound.soundName.get(raw)) },
                                                });
                 break;
             case Type::SubmeshVisibility:
@@ -437,15 +152,14 @@ void Blend::read_v1(File const& file) {
         }
     }
 
-    clips.reserve(header.numClips);
-    for(uint32_t i = 0; i < header.numClips; i++) {
-        using Type = RawClip::RawClipData::Type;
-        auto const& rawClip = *header.clips.get(i);
-        auto const& rawData = *rawClip.data.get(rawClip);
+    clips.reserve(view.clips().size());
+    for(auto const& rawClip: view.clips()) {
+        using Type = BlendView::ClipData::Type;
+        auto const& rawData = BlendView::data_of(rawClip);
         auto base = ClipBase {
             rawClip.flags,
             rawClip.uniqueID,
-            rawClip.name.get(rawClip)
+            std::string { BlendView::name(rawClip) }
         };
         switch(rawData.type) {
         case Type::Invalid:
@@ -477,31 +191,26 @@ void Blend::read_v1(File const& file) {
             if(auto const track = raw.track.get(); track) {
                 result.trackIndex = track->index;
             }
-            if(auto const syncGroupName = raw.syncGroupName.get(); syncGroupName) {
-                result.syncGroupName = syncGroupName;
-            }
-            if(auto const updaterList = raw.updater.get(rawData); updaterList) {
-                result.updaters.reserve(updaterList->numUpdaters);
-                for(uint32_t j = 0; j < updaterList->numUpdaters; j++) {
-                    auto const updater = updaterList->updaters.get(*updaterList, j);
-                    auto result2 = Updater {
-                            updater->inputType,
-                            updater->outputType,
-                            {}
+            result.syncGroupName = BlendView::str(raw.syncGroupName.get());
+            auto const updaters = BlendView::updaters(rawData);
+            result.updaters.reserve(updaters.size());
+            for(auto const& updater: updaters) {
+                auto result2 = Updater {
+                        updater.inputType,
+                        updater.outputType,
+                        {}
+                };
+                result2.processors.reserve(updater.numTransforms);
+                for(auto const& proc: BlendView::processors(updater)) {
+                    auto result3base = BaseProcessor{};
+                    auto result3 = LinerProcessor{
+                            result3base,
+                            proc.data.linearTransform.increment,
+                            proc.data.linearTransform.nultiplier
                     };
-                    result2.processors.reserve(updater->numTransforms);
-                    for(uint32_t k = 0; k < updater->numTransforms; k++) {
-                        auto const proc = updater->processor.get(*updater, k);
-                        auto result3base = BaseProcessor{};
-                        auto result3 = LinerProcessor{
-                                result3base,
-                                proc->data.linearTransform.increment,
-                                proc->data.linearTransform.nultiplier
-                        };
-                        result2.processors.push_back(result3);
-                    }
-                    result.updaters.emplace_back(result2);
+                    result2.processors.push_back(result3);
                 }
+                result.updaters.emplace_back(result2);
             }
             clips.emplace_back(result);
             break;
@@ -515,8 +224,7 @@ void Blend::read_v1(File const& file) {
                     {}
             };
             result.entries.reserve(raw.numPairs);
-            for(uint32_t j = 0; j < raw.numPairs; j++) {
-                auto const& entry = *raw.entries.get(j);
+            for(auto const& entry: raw.entries.span(raw.numPairs)) {
                 result.entries.push_back({
                                              entry.clipID,
                                              entry.probability
@@ -533,8 +241,7 @@ void Blend::read_v1(File const& file) {
                     {}
             };
             result.entries.reserve(raw.numPairs);
-            for(uint32_t j = 0; j < raw.numPairs; j++) {
-                auto const& entry = *raw.entries.get(j);
+            for(auto const& entry: raw.entries.span(raw.numPairs)) {
                 result.entries.push_back({
                                              entry.clipID,
                                          });
@@ -544,21 +251,14 @@ void Blend::read_v1(File const& file) {
         }
         case Type::Parallel:{
             auto const& raw = rawData.data.parallel;
+            auto const clipFlags = BlendView::clip_flags(rawData);
             auto result = ClipParallel {
                     base,
-                    {},
+                    { clipFlags.begin(), clipFlags.end() },
                     {}
             };
-            result.clipFlags.reserve(raw.numClips);
-            if(raw.clipFlags.offset) {
-                for(uint32_t j = 0; j < raw.numClips; j++) {
-                    auto const& entry = *raw.clipFlags.get(rawData, j);
-                    result.clipFlags.push_back(entry);
-                }
-            }
             result.entries.reserve(raw.numClips);
-            for(uint32_t j = 0; j < raw.numClips; j++) {
-                auto const& entry = *raw.entries.get(j);
+            for(auto const& entry: raw.entries.span(raw.numClips)) {
                 result.entries.push_back({
                                              entry.clipID,
                                          });
@@ -589,8 +289,7 @@ void Blend::read_v1(File const& file) {
                 result.trackIndex = track->index;
             }
             result.entries.reserve(raw.numPairs);
-            for(uint32_t j = 0; j < raw.numPairs; j++) {
-                auto const& entry = *raw.entries.get(j);
+            for(auto const& entry: raw.entries.span(raw.numPairs)) {
                 result.entries.push_back({
                                              entry.clipID,
                                              entry.value
@@ -608,8 +307,7 @@ void Blend::read_v1(File const& file) {
                     {},
             };
             result.entries.reserve(raw.numPairs);
-            for(uint32_t j = 0; j < raw.numPairs; j++) {
-                auto const& entry = *raw.entries.get(j);
+            for(auto const& entry: raw.entries.span(raw.numPairs)) {
                 result.entries.push_back({
                                              entry.clipID,
                                              entry.value
@@ -627,8 +325,7 @@ void Blend::read_v1(File const& file) {
                     {},
             };
             result.entries.reserve(raw.numPairs);
-            for(uint32_t j = 0; j < raw.numPairs; j++) {
-                auto const& entry = *raw.entries.get(j);
+            for(auto const& entry: raw.entries.span(raw.numPairs)) {
                 result.entries.push_back({
                                              entry.clipID,
                                              entry.value,
@@ -641,4 +338,33 @@ void Blend::read_v1(File const& file) {
         }
         }
     }
+
+    build_indices();
+}
+
+void Blend::build_indices() {
+    clipIndex = HashIndex<>(clips, [](Clip const& clip) {
+        return std::visit([](ClipBase const& base) { return base.uniqueID; }, clip);
+    });
+    maskIndex = HashIndex<>(masks, [](Mask const& mask) {
+        return mask.uniqueID;
+    });
+    eventIndex = HashIndex<>(eventLists, [](Event const& event) {
+        return event.uniqueID;
+    });
+}
+
+Blend::Clip const* Blend::find_clip(uint32_t uniqueID) const noexcept {
+    auto const index = clipIndex.find(uniqueID);
+    return index != HashIndex<>::none ? &clips[index] : nullptr;
+}
+
+Blend::Mask const* Blend::find_mask(uint32_t uniqueID) const noexcept {
+    auto const index = maskIndex.find(uniqueID);
+    return index != HashIndex<>::none ? &masks[index] : nullptr;
+}
+
+Blend::Event const* Blend::find_event(uint32_t uniqueID) const noexcept {
+    auto const index = eventIndex.find(uniqueID);
+    return index != HashIndex<>::none ? &eventLists[index] : nullptr;
 }
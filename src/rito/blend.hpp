@@ -2,8 +2,11 @@
 #define RITO_BLEND_HPP
 #include "types.hpp"
 #include "file.hpp"
+#include "hashindex.hpp"
 
 namespace Rito {
+    struct BlendView;
+
     struct Blend {
         struct BlendData {
             uint32_t fromAnimId;
@@ -205,8 +208,22 @@ namespace Rito {
         std::string skeletonPath{};
         std::vector<std::string> animationNames;
 
+        // uniqueID to index into clips, masks and eventLists, built by read
+        HashIndex<> clipIndex;
+        HashIndex<> maskIndex;
+        HashIndex<> eventIndex;
+
         void read(File const& file);
         void read_v1(File const& file);
+        // Copies everything out of an already validated view
+        void read(BlendView const& view);
+        // Needs to be called again after clips, masks or eventLists are modified
+        void build_indices();
+
+        // Nullptr when there is no such uniqueID
+        Clip const* find_clip(uint32_t uniqueID) const noexcept;
+        Mask const* find_mask(uint32_t uniqueID) const noexcept;
+        Event const* find_event(uint32_t uniqueID) const noexcept;
     };
 }
 
@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <cmath>
+#include "blendgraph.hpp"
+
+using namespace Rito;
+
+namespace Rito::BlendGraphImpl {
+    using Kind = BlendGraph::Kind;
+    using Node = BlendGraph::Node;
+    using Child = BlendGraph::Child;
+    inline uint32_t lookup(HashIndex<> const& index, std::optional<uint32_t> const& id) noexcept {
+        return id ? index.find(*id) : BlendGraph::none;
+    }
+
+    inline float wrap(float time, float duration) noexcept {
+        if(duration <= 0.0f) {
+            return 0.0f;
+        }
+        auto const result = std::fmod(time, duration);
+        return result < 0.0f ? result + duration : result;
+    }
+
+    inline uint32_t mix(uint32_t seed, uint32_t node) noexcept {
+        auto h = seed ^ (node * 0x9E3779B9u);
+        h ^= h >> 16;
+        h *= 0x85EBCA6Bu;
+        h ^= h >> 13;
+        h *= 0xC2B2AE35u;
+        h ^= h >> 16;
+        return h;
+    }
+
+    struct Builder {
+        BlendGraph& graph;
+        std::vector<uint8_t> marks;
+        std::vector<size_t> layers;
+
+        // Post order walk computing durations and layer bounds, throws on cycles
+        inline void visit(uint32_t n) {
+            if(marks[n] == 2) {
+                return;
+            }
+            file_assert(marks[n] == 0);
+            marks[n] = 1;
+            auto& node = graph.nodes[n];
+            auto duration = node.kind == Kind::Atomic ? node.duration : 0.0f;
+            auto count = size_t { node.kind == Kind::Atomic ? 1u : 0u };
+            for(auto c = node.firstChild; c != node.firstChild + node.childCount; c++) {
+                auto const child = graph.children[c].node;
+                visit(child);
+                auto const childDuration = graph.nodes[child].duration;
+                auto const childLayers = layers[child];
+                switch(node.kind) {
+                case Kind::Sequencer:
+                    duration += childDuration;
+                    count = std::max(count, childLayers);
+                    break;
+                case Kind::Parallel:
+                    duration = std::max(duration, childDuration);
+                    count += childLayers;
+                    break;
+                case Kind::Parametric:
+                    duration = std::max(duration, childDuration);
+                    count = std::max(count, childLayers * 2);
+                    break;
+                default:
+                    duration = std::max(duration, childDuration);
+                    count = std::max(count, childLayers);
+                    break;
+                }
+            }
+            node.duration = duration;
+            layers[n] = count;
+            marks[n] = 2;
+        }
+    };
+
+    struct Evaluator {
+        BlendGraph const& graph;
+        BlendGraph::State& state;
+        std::span<float const> parameters;
+
+        inline float parameter(Node const& node) const noexcept {
+            return node.updaterType < parameters.size() ? parameters[node.updaterType] : 0.0f;
+        }
+
+        inline Child const& child(Node const& node, uint32_t index) const noexcept {
+            return graph.children[node.firstChild + index];
+        }
+
+        inline void evaluate(uint32_t n, float weight, float time, uint32_t track, uint32_t mask) {
+            auto const& node = graph.nodes[n];
+            if(weight <= 0.0f || (node.childCount == 0 && node.kind != Kind::Atomic)) {
+                return;
+            }
+            track = node.track != BlendGraph::none ? node.track : track;
+            mask = node.mask != BlendGraph::none ? node.mask : mask;
+            auto& choice = state.choices[n];
+            switch(node.kind) {
+            case Kind::Invalid:
+                break;
+            case Kind::Atomic:
+                state.layers.push_back({ n, node.animIndex, track, mask, weight, wrap(time, node.duration) });
+                break;
+            case Kind::Selector: {
+                if(choice == BlendGraph::none) {
+                    auto r = static_cast<float>(mix(state.seed, n) >> 8) / static_cast<float>(1u << 24);
+                    choice = node.childCount - 1;
+                    for(uint32_t c = 0; c != node.childCount; c++) {
+                        r -= child(node, c).value;
+                        if(r < 0.0f) {
+                            choice = c;
+                            break;
+                        }
+                    }
+                }
+                evaluate(child(node, choice).node, weight, time, track, mask);
+                break;
+            }
+            case Kind::Sequencer: {
+                auto local = wrap(time, node.duration);
+                for(uint32_t c = 0; c != node.childCount; c++) {
+                    auto const next = child(node, c).node;
+                    auto const duration = graph.nodes[next].duration;
+                    if(local < duration || c + 1 == node.childCount) {
+                        evaluate(next, weight, local, track, mask);
+                        break;
+                    }
+                    local -= duration;
+                }
+                break;
+            }
+            case Kind::Parallel:
+                for(uint32_t c = 0; c != node.childCount; c++) {
+                    evaluate(child(node, c).node, weight, time, track, mask);
+                }
+                break;
+            case Kind::Parametric: {
+                // Children are sorted by value, blend the two around the parameter
+                auto const value = parameter(node);
+                auto hi = uint32_t {};
+                while(hi != node.childCount && child(node, hi).value <= value) {
+                    hi++;
+                }
+                if(hi == 0 || hi == node.childCount) {
+                    evaluate(child(node, hi == 0 ? 0 : hi - 1).node, weight, time, track, mask);
+                    break;
+                }
+                auto const& a = child(node, hi - 1);
+                auto const& b = child(node, hi);
+                auto const f = (value - a.value) / (b.value - a.value);
+                evaluate(a.node, weight * (1.0f - f), time, track, mask);
+                evaluate(b.node, weight * f, time, track, mask);
+                break;
+            }
+            case Kind::ConditionBool: {
+                auto const value = parameter(node) >= 0.5f ? 1.0f : 0.0f;
+                for(uint32_t c = 0; c != node.childCount; c++) {
+                    if(child(node, c).value == value) {
+                        evaluate(child(node, c).node, weight, time, track, mask);
+                        break;
+                    }
+                }
+                break;
+            }
+            case Kind::ConditionFloat: {
+                // Children are sorted by value, hold values add hysteresis around thresholds
+                auto const value = parameter(node);
+                if(choice == BlendGraph::none) {
+                    choice = 0;
+                    while(choice + 1 != node.childCount && child(node, choice + 1).value <= value) {
+                        choice++;
+                    }
+                }
+                while(choice + 1 != node.childCount
+                      && value >= child(node, choice + 1).value + child(node, choice).holdAnimationToHigher) {
+                    choice++;
+                }
+                while(choice != 0 && value < child(node, choice).value - child(node, choice).holdAnimationToLower) {
+                    choice--;
+                }
+                evaluate(child(node, choice).node, weight, time, track, mask);
+                break;
+            }
+            }
+        }
+    };
+}
+
+BlendGraph::BlendGraph(Blend const& blend) {
+    using namespace Rito::BlendGraphImpl;
+    ids = blend.clipIndex;
+    nodes.resize(blend.clips.size());
+    for(size_t i = 0; i != blend.clips.size(); i++) {
+        auto& node = nodes[i];
+        node.firstChild = static_cast<uint32_t>(children.size());
+        auto const add = [&](uint32_t clipID, float value, float higher = 0.0f, float lower = 0.0f) {
+            // References to missing clips are dropped
+            if(auto const index = find(clipID); index != none) {
+                children.push_back({ index, value, higher, lower });
+            }
+        };
+        std::visit([&](auto const& clip) {
+            using T = std::decay_t<decltype(clip)>;
+            node.uniqueID = clip.uniqueID;
+            if constexpr(std::is_same_v<T, Blend::ClipAtomic>) {
+                node.kind = Kind::Atomic;
+                node.animIndex = clip.animIndex.value_or(none);
+                node.track = clip.trackIndex.value_or(none);
+                node.mask = lookup(blend.maskIndex, clip.maskUniqueID);
+                node.eventList = lookup(blend.eventIndex, clip.eventUniqueID);
+                if(clip.endTick > clip.startTick) {
+                    node.duration = static_cast<float>(clip.endTick - clip.startTick) * clip.tickDuration;
+                }
+            } else if constexpr(std::is_same_v<T, Blend::ClipSelector>) {
+                node.kind = Kind::Selector;
+                node.track = clip.trackIndex;
+                for(auto const& entry: clip.entries) {
+                    add(entry.clipID, entry.probability);
+                }
+            } else if constexpr(std::is_same_v<T, Blend::ClipSequencer>) {
+                node.kind = Kind::Sequencer;
+                node.track = clip.trackIndex;
+                for(auto const& entry: clip.entries) {
+                    add(entry.clipID, 0.0f);
+                }
+            } else if constexpr(std::is_same_v<T, Blend::ClipParallel>) {
+                node.kind = Kind::Parallel;
+                for(auto const& entry: clip.entries) {
+                    add(entry.clipID, 0.0f);
+                }
+            } else if constexpr(std::is_same_v<T, Blend::ClipParametric>) {
+                node.kind = Kind::Parametric;
+                node.updaterType = clip.updaterType;
+                node.track = clip.trackIndex.value_or(none);
+                node.mask = lookup(blend.maskIndex, clip.maskUniqueID);
+                for(auto const& entry: clip.entries) {
+                    add(entry.clipID, entry.value);
+                }
+            } else if constexpr(std::is_same_v<T, Blend::ClipConditionBool>) {
+                node.kind = Kind::ConditionBool;
+                node.updaterType = clip.updaterType;
+                node.changeAnimationMidPlay = clip.changeAnimationMidPlay;
+                for(auto const& entry: clip.entries) {
+                    add(entry.clipID, entry.value ? 1.0f : 0.0f);
+                }
+            } else if constexpr(std::is_same_v<T, Blend::ClipConditionFloat>) {
+                node.kind = Kind::ConditionFloat;
+                node.updaterType = clip.updaterType;
+                node.changeAnimationMidPlay = clip.changeAnimationMidPlay;
+                for(auto const& entry: clip.entries) {
+                    add(entry.clipID, entry.value, entry.holdAnimationToHigher, entry.holdAnimationToLower);
+                }
+            }
+        }, blend.clips[i]);
+        node.childCount = static_cast<uint32_t>(children.size()) - node.firstChild;
+
+        auto const begin = children.begin() + node.firstChild;
+        auto const end = children.end();
+        if(node.kind == Kind::Parametric || node.kind == Kind::ConditionFloat) {
+            std::stable_sort(begin, end, [](Child const& l, Child const& r) {
+                return l.value < r.value;
+            });
+        } else if(node.kind == Kind::Selector) {
+            auto total = 0.0f;
+            for(auto c = begin; c != end; c++) {
+                total += std::max(c->value, 0.0f);
+            }
+            for(auto c = begin; c != end; c++) {
+                c->value = total > 0.0f ? std::max(c->value, 0.0f) / total : 1.0f / static_cast<float>(node.childCount);
+            }
+        }
+    }
+
+    auto builder = Builder { *this, std::vector<uint8_t>(nodes.size()), std::vector<size_t>(nodes.size()) };
+    for(uint32_t n = 0; n != nodes.size(); n++) {
+        builder.visit(n);
+    }
+    for(auto const count: builder.layers) {
+        maxLayers = std::max(maxLayers, count);
+    }
+}
+
+uint32_t BlendGraph::find(uint32_t uniqueID) const noexcept {
+    return ids.find(uniqueID);
+}
+
+BlendGraph::State BlendGraph::make_state(uint32_t seed) const {
+    auto state = State { std::vector<uint32_t>(nodes.size(), none), {}, seed };
+    state.layers.reserve(maxLayers);
+    return state;
+}
+
+void BlendGraph::evaluate(State& state, uint32_t root, float time, std::span<float const> parameters) const {
+    file_assert(root < nodes.size() && state.choices.size() == nodes.size());
+    state.layers.clear();
+    auto evaluator = BlendGraphImpl::Evaluator { *this, state, parameters };
+    evaluator.evaluate(root, 1.0f, time, none, none);
+    std::sort(state.layers.begin(), state.layers.end(), [](Layer const& l, Layer const& r) {
+        return l.track != r.track ? l.track < r.track : l.node < r.node;
+    });
+}
@@ -0,0 +1,89 @@
+#ifndef RITO_BLENDGRAPH_HPP
+#define RITO_BLENDGRAPH_HPP
+#include <cinttypes>
+#include <span>
+#include <vector>
+#include "blend.hpp"
+
+namespace Rito {
+    // Clip graph of a Blend flattened into index based nodes, every uniqueID is resolved once on construction
+    // through the indices of Blend.
+    // Evaluation only touches the per actor State and does not allocate.
+    struct BlendGraph {
+        static constexpr uint32_t none = ~0u;
+
+        enum class Kind : uint8_t {
+            Invalid,
+            Atomic,
+            Selector,
+            Sequencer,
+            Parallel,
+            Parametric,
+            ConditionBool,
+            ConditionFloat,
+        };
+
+        struct Node {
+            Kind kind = Kind::Invalid;
+            bool changeAnimationMidPlay = {};
+            uint32_t uniqueID = {};
+            uint32_t firstChild = {};
+            uint32_t childCount = {};
+            uint32_t animIndex = none;
+            // Blend::Track::index, inherited by children that do not set their own
+            uint32_t track = none;
+            // Index into Blend::masks, inherited like track
+            uint32_t mask = none;
+            // Index into Blend::eventLists
+            uint32_t eventList = none;
+            // Parameter slot read by parametric and condition nodes
+            uint32_t updaterType = {};
+            // Length of one loop in seconds
+            float duration = {};
+        };
+
+        struct Child {
+            uint32_t node;
+            // Probability for selectors, threshold for parametric and condition nodes
+            float value;
+            float holdAnimationToHigher;
+            float holdAnimationToLower;
+        };
+
+        struct Layer {
+            uint32_t node;
+            uint32_t animIndex;
+            uint32_t track;
+            uint32_t mask;
+            float weight;
+            // Local time inside the atomic clip in seconds
+            float time;
+        };
+
+        // Per actor state, choices of selectors and float conditions stick between ticks
+        struct State {
+            std::vector<uint32_t> choices;
+            std::vector<Layer> layers;
+            uint32_t seed;
+        };
+
+        std::vector<Node> nodes;
+        std::vector<Child> children;
+        // Nodes mirror Blend::clips so this is a copy of Blend::clipIndex
+        HashIndex<> ids;
+        // Upper bound of layers any node can produce
+        size_t maxLayers = {};
+
+        BlendGraph(Blend const& blend);
+
+        // Node index of clip with uniqueID or none
+        uint32_t find(uint32_t uniqueID) const noexcept;
+
+        State make_state(uint32_t seed = 0) const;
+
+        // Fills state.layers sorted by track, parameters are indexed by updaterType and read as 0 when missing
+        void evaluate(State& state, uint32_t root, float time, std::span<float const> parameters) const;
+    };
+}
+
+#endif // RITO_BLENDGRAPH_HPP
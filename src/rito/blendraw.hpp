@@ -0,0 +1,286 @@
+#ifndef RITO_BLENDRAW_HPP
+#define RITO_BLENDRAW_HPP
+#include <cinttypes>
+#include <array>
+#include "file.hpp"
+#include "memory.hpp"
+
+// On disk layout of r3d2blnd version 1 resources, addressed in place through Rito::Mem pointers
+namespace Rito::BlendImpl {
+    namespace new_v1 {
+        using namespace Rito::Mem;
+        using Rito::Mem::FlexArr;
+        using Rito::Mem::AbsPtr;
+        using Rito::Mem::RelPtr;
+        using Rito::Mem::AbsPtrArr;
+        using Rito::Mem::RelPtrArr;
+
+        struct RawPath {
+            uint32_t hash;
+            RelPtr<char> path;
+        };
+
+        struct RawBlendData {
+            uint32_t fromAnimId;
+            uint32_t toAnimId;
+            uint32_t blendFlags;
+            float blendTime;
+        };
+
+        struct RawTransitionClip {
+            struct To {
+                uint32_t toAnimId;
+                uint32_t transitionAnimId;
+            };
+            uint32_t fromAnimID;
+            uint32_t numTransitions;
+            RelPtr<To> transitions;
+        };
+
+        struct RawTrack : BaseResource {
+            float blendWeight;
+            uint32_t blendMode;
+            uint32_t index;
+            std::array<char, 32> name;
+        };
+
+        struct RawMask : BaseResource {
+            struct RawJointHash {
+                int32_t weightID;
+                uint32_t jointHash;
+            };
+            struct RawJointIndex {
+                int32_t weightID;
+                uint32_t jointHash;
+            };
+            uint32_t formatToken;
+            uint32_t version;
+            uint16_t flags;
+            uint16_t numElements;
+            uint32_t uniqueID;
+            AbsPtr<float> weights;
+            AbsPtr<RawJointHash> jointHashes;
+            AbsPtr<RawJointIndex> jointIndices;
+            std::array<uint32_t, 2> extBuffer;
+        };
+
+        struct RawEvent : BaseResource {
+            struct RawEventHash {
+                uint32_t dataID;
+                uint32_t nameHash;
+            };
+            struct RawEventFrame {
+                uint32_t dataID;
+                float frame;
+            };
+            struct RawEventData : BaseResource {
+                enum class Type : uint32_t {
+                    Particle = 0x0,
+                    Sound = 0x1,
+                    SubmeshVisibility = 0x2,
+                    Fade = 0x3,
+                    JointSnap = 0x4,
+                    EnableLookAt = 0x5,
+                };
+                Type type;
+                uint32_t flags;
+                float frame;
+                AbsPtr<char> name;
+                union {
+                    struct {
+                        AbsPtr<char> effectName;
+                        AbsPtr<char> boneName;
+                        AbsPtr<char> targetBoneName;
+                        float endFrame;
+                    } particle;
+                    struct {
+                        AbsPtr<char> soundName;
+                    } sound;
+                    struct {
+                        float endFrame;
+                        uint32_t showSubmeshHash;
+                        uint32_t hideSubmeshHash;
+                    } submeshVisibility;
+                    struct {
+                        float timeToFade;
+                        float targeAlpha;
+                        float endFrame;
+                    } fade;
+                    struct {
+                        float endFrame;
+                        uint16_t jointToOverrideIndex;
+                        uint16_t jointToSnapToIndex;
+                    } jointSnap;
+                    struct {
+                        float endFrame;
+                        uint32_t enableLookAt;
+                        uint32_t lockCurrentValues;
+                    } enableLookAt;
+                } data;
+            };
+            uint32_t formatToken;
+            uint32_t version;
+            uint16_t flags;
+            uint16_t numEvents;
+            uint32_t uniqueID;
+            AbsPtrArr<RawEventData> eventsData;
+            AbsPtr<RawEventData> eventData;
+            AbsPtr<RawEventHash> eventHashes;
+            AbsPtr<RawEventFrame> eventFrames;
+            AbsPtr<char> name;
+            std::array<uint32_t, 2> extBuffer;
+        };
+
+        struct RawClip : BaseResource {
+            struct RawUpdater : BaseResource {
+                struct RawUpdaterData : BaseResource {
+                    struct RawProcessor : BaseResource {
+                        uint16_t type;
+                        uint16_t pad;
+                        union {
+                            struct {
+                                float nultiplier;
+                                float increment;
+                            } linearTransform;
+                        } data;
+                    };
+                    uint16_t inputType;
+                    uint16_t outputType;
+                    uint8_t numTransforms;
+                    uint8_t pad;
+                    AbsPtr<RawProcessor> processor;
+                };
+                uint32_t version;
+                uint16_t numUpdaters;
+                uint16_t pad;
+                AbsPtrArr<RawUpdaterData> updaters;
+            };
+
+            struct RawClipData {
+                enum class Type : uint32_t {
+                    Invalid,
+                    Atomic,
+                    Selector,
+                    Sequencer,
+                    Parallel,
+                    MultiChildClip,
+                    Parametric,
+                    ConditionBool,
+                    ConditionFloat,
+                };
+                Type type;
+                union {
+                    struct {
+                        uint32_t startTick;
+                        uint32_t endTick;
+                        float tickDuration;
+                        uint32_t animIndex;
+                        RelPtr<RawEvent> event; // ptr
+                        RelPtr<RawMask> mask; // ptr
+                        RelPtr<RawTrack> track; // ptr
+                        AbsPtr<RawUpdater> updater;
+                        RelPtr<char> syncGroupName;
+                        uint32_t syncGroup;
+                        std::array<uint32_t, 2> extBuffer;
+                    } atomic; // TODO 1
+                    struct {
+                        struct Entry {
+                            uint32_t clipID;
+                            float probability;
+                        };
+                        uint32_t trackIndex;
+                        uint32_t numPairs;
+                        FlexArr<Entry> entries;
+                    } selector;
+                    struct {
+                        struct Entry {
+                            uint32_t clipID; // children?
+                        };
+                        uint32_t trackIndex;
+                        uint32_t numPairs;
+                        FlexArr<Entry> entries;
+                    } sequencer;
+                    struct {
+                        struct Entry {
+                            uint32_t clipID; // children?
+                        };
+                        AbsPtr<uint32_t> clipFlags;
+                        uint32_t numClips;
+                        FlexArr<Entry> entries;
+                    } parallel;
+                    struct {
+                    } multiChild;
+                    struct {
+                        struct Entry {
+                            uint32_t clipID;
+                            float value;
+                        };
+                        uint32_t numPairs;
+                        uint32_t updaterType;
+                        RelPtr<RawMask> mask;
+                        RelPtr<RawTrack> track;
+                        FlexArr<Entry> entries;
+                    } parametric;
+                    struct {
+                        struct Entry {
+                            uint32_t clipID;
+                            bool value;
+                            uint8_t pad[3];
+                        };
+                        uint32_t numPairs;
+                        uint32_t updaterType;
+                        bool changeAnimationMidPlay;
+                        uint8_t pad[3];
+                        FlexArr<Entry> entries;
+                    } conditionBool;
+                    struct {
+                        struct Entry {
+                            uint32_t clipID;
+                            float value;
+                            float holdAnimationToHigher;
+                            float holdAnimationToLower;
+                        };
+                        uint32_t numPairs;
+                        uint32_t updaterType;
+                        bool changeAnimationMidPlay;
+                        uint8_t pad[3];
+                        FlexArr<Entry> entries;
+                    } conditionFloat;
+                } data;
+            };
+            uint16_t flags;
+            uint16_t pad;
+            uint32_t uniqueID;
+            AbsPtr<char> name;
+            AbsPtr<RawClipData> data;
+        };
+
+        struct Header : BaseResource {
+            uint32_t formatToken;
+            uint32_t version;
+            uint32_t numClips;
+            uint32_t numBlends;
+            uint32_t numTransitionClips;
+            uint32_t numTracks;
+            uint32_t numAnimData;
+            uint32_t numMasks;
+            uint32_t numEvents;
+            bool useCascadeBlend;
+            uint8_t pad[3];
+            float cascadeBlendValue;
+            RelPtr<RawBlendData> blendData;
+            RelPtr<RawTransitionClip> transitionClips;
+            RelPtr<RawTrack> blendTracks;
+            RelPtrArr<RawClip> clips;
+            RelPtrArr<RawMask> masks;
+            RelPtrArr<RawEvent> events;
+            uint32_t animsData;
+            uint32_t animNameCount;
+            RelPtr<RawPath> animNamesOffset;
+            RawPath skeleton;
+            std::array<uint32_t, 1> extBuffer;
+        };
+    }
+}
+
+#endif // RITO_BLENDRAW_HPP
@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <cmath>
+#include "blendtimeline.hpp"
+
+using namespace Rito;
+
+namespace Rito::BlendTimelineImpl {
+    using Event = Blend::Event;
+
+    inline InternedString intern(EventTimeline& timeline, std::string const& str) {
+        return timeline.strings->intern(str);
+    }
+
+    inline void push(EventTimeline& timeline, EventTimeline::Columns& columns, Event::EventBase const& base, uint32_t index) {
+        columns.frames.push_back(base.frame);
+        columns.flags.push_back(base.flags);
+        columns.names.push_back(intern(timeline, base.name));
+        columns.indices.push_back(index);
+    }
+
+    inline void push(EventTimeline& timeline, Event::EventParticle const& data, uint32_t index) {
+        push(timeline, timeline.particles, data, index);
+        timeline.particles.effectNames.push_back(intern(timeline, data.effectName));
+        timeline.particles.boneNames.push_back(intern(timeline, data.boneName));
+        timeline.particles.targetBoneNames.push_back(intern(timeline, data.targetBoneName));
+        timeline.particles.endFrames.push_back(data.endFrame);
+    }
+
+    inline void push(EventTimeline& timeline, Event::EventSoundName const& data, uint32_t index) {
+        push(timeline, timeline.sounds, data, index);
+        timeline.sounds.soundNames.push_back(intern(timeline, data.soundName));
+    }
+
+    inline void push(EventTimeline& timeline, Event::EventSubmeshVisibility const& data, uint32_t index) {
+        push(timeline, timeline.submeshVisibilities, data, index);
+        timeline.submeshVisibilities.endFrames.push_back(data.endFrame);
+        timeline.submeshVisibilities.showSubmeshHashes.push_back(data.showSubmeshHash);
+        timeline.submeshVisibilities.hideSubmeshHashes.push_back(data.hideSubmeshHash);
+    }
+
+    inline void push(EventTimeline& timeline, Event::EventFade const& data, uint32_t index) {
+        push(timeline, timeline.fades, data, index);
+        timeline.fades.timeToFades.push_back(data.timeToFade);
+        timeline.fades.targetAlphas.push_back(data.targeAlpha);
+        timeline.fades.endFrames.push_back(data.endFrame);
+    }
+
+    inline void push(EventTimeline& timeline, Event::EventJointSnap const& data, uint32_t index) {
+        push(timeline, timeline.jointSnaps, data, index);
+        timeline.jointSnaps.endFrames.push_back(data.endFrame);
+        timeline.jointSnaps.jointToOverrideIndices.push_back(data.jointToOverrideIndex);
+        timeline.jointSnaps.jointToSnapToIndices.push_back(data.jointToSnapToIndex);
+    }
+
+    inline void push(EventTimeline& timeline, Event::EventEnableLookAt const& data, uint32_t index) {
+        push(timeline, timeline.enableLookAts, data, index);
+        timeline.enableLookAts.endFrames.push_back(data.endFrame);
+        timeline.enableLookAts.enableLookAts.push_back(data.enableLookAt);
+        timeline.enableLookAts.lockCurrentValues.push_back(data.lockCurrentValues);
+    }
+}
+
+std::pair<size_t, size_t> EventTimeline::Columns::range(float from, float to) const noexcept {
+    auto const first = std::lower_bound(frames.begin(), frames.end(), from);
+    auto const last = std::lower_bound(first, frames.end(), to);
+    return { static_cast<size_t>(first - frames.begin()), static_cast<size_t>(last - frames.begin()) };
+}
+
+EventTimeline::EventTimeline(Blend::Event const& event, std::shared_ptr<StringPool> strings)
+    : uniqueID(event.uniqueID),
+      strings(StringPool::shared_or_new(std::move(strings))) {
+    // Visiting in frame order fills every column already sorted
+    std::vector<uint32_t> order(event.eventsData.size());
+    for(uint32_t i = 0; i != order.size(); i++) {
+        order[i] = i;
+    }
+    auto const frame_of = [&event](uint32_t i) {
+        return std::visit([](Blend::Event::EventBase const& base) { return base.frame; }, event.eventsData[i]);
+    };
+    // NaN would break the ordering of the sort and of range()
+    for(auto const i: order) {
+        file_assert(std::isfinite(frame_of(i)));
+    }
+    std::stable_sort(order.begin(), order.end(), [&frame_of](uint32_t l, uint32_t r) {
+        return frame_of(l) < frame_of(r);
+    });
+    for(auto const i: order) {
+        std::visit([this, i](auto const& data) { BlendTimelineImpl::push(*this, data, i); }, event.eventsData[i]);
+    }
+}
+
+std::vector<EventTimeline> Rito::BuildEventTimelines(Blend const& blend, std::shared_ptr<StringPool> strings) {
+    strings = StringPool::shared_or_new(std::move(strings));
+    std::vector<EventTimeline> result;
+    result.reserve(blend.eventLists.size());
+    for(auto const& event: blend.eventLists) {
+        result.emplace_back(event, strings);
+    }
+    return result;
+}
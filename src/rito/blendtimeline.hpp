@@ -0,0 +1,82 @@
+#ifndef RITO_BLENDTIMELINE_HPP
+#define RITO_BLENDTIMELINE_HPP
+#include <cinttypes>
+#include <utility>
+#include <vector>
+#include "blend.hpp"
+#include "stringpool.hpp"
+
+namespace Rito {
+    // Events of one Blend::Event list split by type into columns sorted by frame,
+    // a frame range query is a binary search followed by a contiguous scan.
+    struct EventTimeline {
+        struct Columns {
+            std::vector<float> frames;
+            std::vector<uint32_t> flags;
+            std::vector<InternedString> names;
+            // Position in Blend::Event::eventsData
+            std::vector<uint32_t> indices;
+
+            // Rows [first, second) with from <= frame < to
+            std::pair<size_t, size_t> range(float from, float to) const noexcept;
+
+            inline size_t size() const noexcept {
+                return frames.size();
+            }
+        };
+
+        struct Particles : Columns {
+            std::vector<InternedString> effectNames;
+            std::vector<InternedString> boneNames;
+            std::vector<InternedString> targetBoneNames;
+            std::vector<float> endFrames;
+        };
+
+        struct Sounds : Columns {
+            std::vector<InternedString> soundNames;
+        };
+
+        struct SubmeshVisibilities : Columns {
+            std::vector<float> endFrames;
+            std::vector<uint32_t> showSubmeshHashes;
+            std::vector<uint32_t> hideSubmeshHashes;
+        };
+
+        struct Fades : Columns {
+            std::vector<float> timeToFades;
+            std::vector<float> targetAlphas;
+            std::vector<float> endFrames;
+        };
+
+        struct JointSnaps : Columns {
+            std::vector<float> endFrames;
+            std::vector<uint16_t> jointToOverrideIndices;
+            std::vector<uint16_t> jointToSnapToIndices;
+        };
+
+        struct EnableLookAts : Columns {
+            std::vector<float> endFrames;
+            std::vector<uint32_t> enableLookAts;
+            std::vector<uint32_t> lockCurrentValues;
+        };
+
+        uint32_t uniqueID = {};
+        Particles particles;
+        Sounds sounds;
+        SubmeshVisibilities submeshVisibilities;
+        Fades fades;
+        JointSnaps jointSnaps;
+        EnableLookAts enableLookAts;
+        // Pool of the event names
+        std::shared_ptr<StringPool> strings;
+
+        EventTimeline() noexcept = default;
+        // Names go into strings, a new pool when it is null
+        EventTimeline(Blend::Event const& event, std::shared_ptr<StringPool> strings = {});
+    };
+
+    // One timeline per Blend::eventLists entry, in the same order, all of them share one pool
+    extern std::vector<EventTimeline> BuildEventTimelines(Blend const& blend, std::shared_ptr<StringPool> strings = {});
+}
+
+#endif // RITO_BLENDTIMELINE_HPP
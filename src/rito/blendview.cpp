@@ -0,0 +1,334 @@
+#include <cstring>
+#include "blendview.hpp"
+
+using namespace Rito;
+
+namespace Rito::BlendImpl {
+    struct Validator {
+        uintptr_t begin;
+        uintptr_t end;
+
+        inline void check_bytes(void const* ptr, size_t size, size_t align) const {
+            auto const p = reinterpret_cast<uintptr_t>(ptr);
+            file_assert(ptr && p >= begin && p <= end && p % align == 0);
+            file_assert(size <= end - p);
+        }
+
+        template<typename T>
+        inline T const& check(T const* ptr) const {
+            check_bytes(ptr, sizeof(T), alignof(T));
+            return *ptr;
+        }
+
+        // Pointer can only be null when there are no elements
+        template<typename T>
+        inline std::span<T const> check(std::span<T const> span, size_t count) const {
+            if(count != 0) {
+                file_assert(span.size() == count);
+                check_bytes(span.data(), sizeof(T) * count, alignof(T));
+            }
+            return span;
+        }
+
+        // Entries must be non null and hold at least size bytes. Union based records pass only their common
+        // header here and check the member their type uses with check_member
+        template<typename T>
+        inline void check(Mem::PtrSpan<T> const& span, size_t count, size_t size = sizeof(T)) const {
+            if(count == 0) {
+                return;
+            }
+            file_assert(span.size() == count);
+            check_bytes(span.offsets, sizeof(int32_t) * count, alignof(int32_t));
+            for(size_t i = 0; i != count; i++) {
+                auto const offset = span.offsets[i];
+                file_assert(offset != 0 && offset != -1);
+                check_bytes(reinterpret_cast<void const*>(reinterpret_cast<uintptr_t>(span.base) + offset),
+                            size,
+                            alignof(T));
+            }
+        }
+
+        // Null strings are allowed
+        inline void check_str(char const* ptr) const {
+            if(!ptr) {
+                return;
+            }
+            check_bytes(ptr, 1, 1);
+            file_assert(memchr(ptr, 0, end - reinterpret_cast<uintptr_t>(ptr)));
+        }
+
+        // Union based structs are only as big as the member their type uses
+        template<typename T, typename M>
+        inline void check_member(T const* ptr, M const& member) const {
+            auto const size = reinterpret_cast<uintptr_t>(&member) - reinterpret_cast<uintptr_t>(ptr) + sizeof(M);
+            check_bytes(ptr, size, alignof(T));
+        }
+    };
+
+    inline void validate(Validator const& v, BlendView::Mask const& mask) {
+        v.check(mask.weights.span(mask, mask.numElements), mask.numElements);
+        v.check(mask.jointHashes.span(mask, mask.numElements), mask.numElements);
+    }
+
+    inline void validate(Validator const& v, BlendView::Event const& event) {
+        using Type = BlendView::EventData::Type;
+        v.check_str(event.name.get(event));
+        auto const eventsData = event.eventsData.span(event, event.numEvents);
+        v.check(eventsData, event.numEvents, sizeof(BlendView::EventData) - sizeof(BlendView::EventData::data));
+        for(auto const& raw: eventsData) {
+            v.check_str(raw.name.get(raw));
+            switch(raw.type) {
+            case Type::Particle:
+                v.check_member(&raw, raw.data.particle);
+                v.check_str(raw.data.particle.effectName.get(raw));
+                v.check_str(raw.data.particle.boneName.get(raw));
+                v.check_str(raw.data.particle.targetBoneName.get(raw));
+                break;
+            case Type::Sound:
+                v.check_member(&raw, raw.data.sound);
+                v.check_str(raw.data.sound.soundName.get(raw));
+                break;
+            case Type::SubmeshVisibility:
+                v.check_member(&raw, raw.data.submeshVisibility);
+                break;
+            case Type::Fade:
+                v.check_member(&raw, raw.data.fade);
+                break;
+            case Type::JointSnap:
+                v.check_member(&raw, raw.data.jointSnap);
+                break;
+            case Type::EnableLookAt:
+                v.check_member(&raw, raw.data.enableLookAt);
+                break;
+            }
+        }
+    }
+
+    template<typename T>
+    inline void validate_entries(Validator const& v, BlendView::ClipData const& clipData, T const& raw, size_t count) {
+        v.check_member(&clipData, raw);
+        v.check(raw.entries.span(count), count);
+    }
+
+    inline void validate(Validator const& v, BlendView::Clip const& clip) {
+        using Type = BlendView::ClipData::Type;
+        v.check_str(clip.name.get(clip));
+        auto const rawDataPtr = clip.data.get(clip);
+        v.check_bytes(rawDataPtr, sizeof(BlendView::ClipData::Type), alignof(BlendView::ClipData));
+        auto const& rawData = *rawDataPtr;
+        switch(rawData.type) {
+        case Type::Invalid:
+            break;
+        case Type::Atomic: {
+            auto const& raw = rawData.data.atomic;
+            v.check_member(&rawData, raw);
+            if(auto const event = raw.event.get(); event) {
+                v.check(event);
+            }
+            if(auto const mask = raw.mask.get(); mask) {
+                v.check(mask);
+            }
+            if(auto const track = raw.track.get(); track) {
+                v.check(track);
+            }
+            v.check_str(raw.syncGroupName.get());
+            if(auto const updaterList = raw.updater.get(rawData); updaterList) {
+                v.check(updaterList);
+                auto const updaters = updaterList->updaters.span(*updaterList, updaterList->numUpdaters);
+                v.check(updaters, updaterList->numUpdaters);
+                for(auto const& updater: updaters) {
+                    v.check(updater.processor.span(updater, updater.numTransforms), updater.numTransforms);
+                }
+            }
+            break;
+        }
+        case Type::Selector:
+            validate_entries(v, rawData, rawData.data.selector, rawData.data.selector.numPairs);
+            break;
+        case Type::Sequencer:
+            validate_entries(v, rawData, rawData.data.sequencer, rawData.data.sequencer.numPairs);
+            break;
+        case Type::Parallel: {
+            auto const& raw = rawData.data.parallel;
+            validate_entries(v, rawData, raw, raw.numClips);
+            if(auto const clipFlags = raw.clipFlags.span(rawData, raw.numClips); !clipFlags.empty()) {
+                v.check(clipFlags, raw.numClips);
+            }
+            break;
+        }
+        case Type::MultiChildClip:
+            break;
+        case Type::Parametric: {
+            auto const& raw = rawData.data.parametric;
+            validate_entries(v, rawData, raw, raw.numPairs);
+            if(auto const mask = raw.mask.get(); mask) {
+                v.check(mask);
+            }
+            if(auto const track = raw.track.get(); track) {
+                v.check(track);
+            }
+            break;
+        }
+        case Type::ConditionBool:
+            validate_entries(v, rawData, rawData.data.conditionBool, rawData.data.conditionBool.numPairs);
+            break;
+        case Type::ConditionFloat:
+            validate_entries(v, rawData, rawData.data.conditionFloat, rawData.data.conditionFloat.numPairs);
+            break;
+        }
+    }
+
+    inline void validate(BlendView const& view) {
+        file_assert(view.data.size() >= sizeof(BlendView::Header));
+        auto const begin = reinterpret_cast<uintptr_t>(view.data.data());
+        auto const v = Validator { begin, begin + view.data.size() };
+        auto const& header = view.header();
+        file_assert(header.version == 0);
+
+        v.check_str(header.skeleton.path.get());
+        for(auto const& path: v.check(header.animNamesOffset.span(header.animNameCount), header.animNameCount)) {
+            v.check_str(path.path.get());
+        }
+        v.check(header.blendData.span(header.numBlends), header.numBlends);
+        auto const transitionClips = header.transitionClips.span(header.numTransitionClips);
+        for(auto const& transitionClip: v.check(transitionClips, header.numTransitionClips)) {
+            v.check(transitionClip.transitions.span(transitionClip.numTransitions), transitionClip.numTransitions);
+        }
+        v.check(header.blendTracks.span(header.numTracks), header.numTracks);
+
+        auto const masks = header.masks.span(header.numMasks);
+        v.check(masks, header.numMasks);
+        for(auto const& mask: masks) {
+            validate(v, mask);
+        }
+
+        auto const events = header.events.span(header.numEvents);
+        v.check(events, header.numEvents);
+        for(auto const& event: events) {
+            validate(v, event);
+        }
+
+        auto const clips = header.clips.span(header.numClips);
+        v.check(clips, header.numClips);
+        for(auto const& clip: clips) {
+            validate(v, clip);
+        }
+    }
+}
+
+BlendView::BlendView(File const& file) {
+    struct Magic {
+        std::array<char, 8> magic;
+        uint32_t version;
+    };
+
+    Magic magic{};
+    file.read(magic);
+    file_assert((magic.magic == std::array{'r','3','d','2','b','l','n','d'}));
+    file_assert(magic.version == 1);
+
+    auto const oldPos = file.tell();
+    file.seek_end(0);
+    auto const dataSize = file.tell() - oldPos;
+    file.seek_beg(oldPos);
+    file.read(data, dataSize);
+    BlendImpl::validate(*this);
+}
+
+BlendView::BlendView(std::vector<uint8_t> data) : data(std::move(data)) {
+    BlendImpl::validate(*this);
+}
+
+std::string_view BlendView::skeleton_path() const noexcept {
+    return str(header().skeleton.path.get());
+}
+
+std::span<BlendView::Path const> BlendView::animation_names() const noexcept {
+    return header().animNamesOffset.span(header().animNameCount);
+}
+
+std::span<BlendView::BlendData const> BlendView::blend_data() const noexcept {
+    return header().blendData.span(header().numBlends);
+}
+
+std::span<BlendView::TransitionClip const> BlendView::transition_clips() const noexcept {
+    return header().transitionClips.span(header().numTransitionClips);
+}
+
+std::span<BlendView::Track const> BlendView::tracks() const noexcept {
+    return header().blendTracks.span(header().numTracks);
+}
+
+Mem::PtrSpan<BlendView::Clip> BlendView::clips() const noexcept {
+    return header().clips.span(header().numClips);
+}
+
+Mem::PtrSpan<BlendView::Mask> BlendView::masks() const noexcept {
+    return header().masks.span(header().numMasks);
+}
+
+Mem::PtrSpan<BlendView::Event> BlendView::events() const noexcept {
+    return header().events.span(header().numEvents);
+}
+
+std::string_view BlendView::name(Path const& path) noexcept {
+    return str(path.path.get());
+}
+
+std::string_view BlendView::name(Track const& track) noexcept {
+    auto const end = std::find(track.name.begin(), track.name.end(), '\0');
+    return { track.name.data(), static_cast<size_t>(end - track.name.begin()) };
+}
+
+std::string_view BlendView::name(Event const& event) noexcept {
+    return str(event.name.get(event));
+}
+
+std::string_view BlendView::name(EventData const& eventData) noexcept {
+    return str(eventData.name.get(eventData));
+}
+
+std::string_view BlendView::name(Clip const& clip) noexcept {
+    return str(clip.name.get(clip));
+}
+
+std::span<BlendView::TransitionClip::To const> BlendView::transitions(TransitionClip const& transitionClip) noexcept {
+    return transitionClip.transitions.span(transitionClip.numTransitions);
+}
+
+std::span<float const> BlendView::weights(Mask const& mask) noexcept {
+    return mask.weights.span(mask, mask.numElements);
+}
+
+std::span<BlendView::Mask::RawJointHash const> BlendView::joint_hashes(Mask const& mask) noexcept {
+    return mask.jointHashes.span(mask, mask.numElements);
+}
+
+Mem::PtrSpan<BlendView::EventData> BlendView::events_data(Event const& event) noexcept {
+    return event.eventsData.span(event, event.numEvents);
+}
+
+BlendView::ClipData const& BlendView::data_of(Clip const& clip) noexcept {
+    return *clip.data.get(clip);
+}
+
+Mem::PtrSpan<BlendView::Updater> BlendView::updaters(ClipData const& clipData) noexcept {
+    if(clipData.type != ClipData::Type::Atomic) {
+        return {};
+    }
+    if(auto const updaterList = clipData.data.atomic.updater.get(clipData); updaterList) {
+        return updaterList->updaters.span(*updaterList, updaterList->numUpdaters);
+    }
+    return {};
+}
+
+std::span<BlendView::Processor const> BlendView::processors(Updater const& updater) noexcept {
+    return updater.processor.span(updater, updater.numTransforms);
+}
+
+std::span<uint32_t const> BlendView::clip_flags(ClipData const& clipData) noexcept {
+    if(clipData.type != ClipData::Type::Parallel) {
+        return {};
+    }
+    return clipData.data.parallel.clipFlags.span(clipData, clipData.data.parallel.numClips);
+}
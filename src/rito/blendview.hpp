@@ -0,0 +1,71 @@
+#ifndef RITO_BLENDVIEW_HPP
+#define RITO_BLENDVIEW_HPP
+#include <cinttypes>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "file.hpp"
+#include "memory.hpp"
+#include "blendraw.hpp"
+
+namespace Rito {
+    // Read only view over the raw r3d2blnd resource. Every pointer is validated against the
+    // buffer once on construction, after that all accessors address the raw structs in place.
+    struct BlendView {
+        using Header = BlendImpl::new_v1::Header;
+        using Path = BlendImpl::new_v1::RawPath;
+        using BlendData = BlendImpl::new_v1::RawBlendData;
+        using TransitionClip = BlendImpl::new_v1::RawTransitionClip;
+        using Track = BlendImpl::new_v1::RawTrack;
+        using Mask = BlendImpl::new_v1::RawMask;
+        using Event = BlendImpl::new_v1::RawEvent;
+        using EventData = BlendImpl::new_v1::RawEvent::RawEventData;
+        using Clip = BlendImpl::new_v1::RawClip;
+        using ClipData = BlendImpl::new_v1::RawClip::RawClipData;
+        using Updater = BlendImpl::new_v1::RawClip::RawUpdater::RawUpdaterData;
+        using Processor = BlendImpl::new_v1::RawClip::RawUpdater::RawUpdaterData::RawProcessor;
+
+        // Resource data following the file magic and version
+        std::vector<uint8_t> data;
+
+        BlendView(File const& file);
+        BlendView(std::vector<uint8_t> data);
+
+        inline Header const& header() const noexcept {
+            return *reinterpret_cast<Header const*>(data.data());
+        }
+
+        std::string_view skeleton_path() const noexcept;
+        std::span<Path const> animation_names() const noexcept;
+        std::span<BlendData const> blend_data() const noexcept;
+        std::span<TransitionClip const> transition_clips() const noexcept;
+        std::span<Track const> tracks() const noexcept;
+        Mem::PtrSpan<Clip> clips() const noexcept;
+        Mem::PtrSpan<Mask> masks() const noexcept;
+        Mem::PtrSpan<Event> events() const noexcept;
+
+        // Null pointers read as empty strings
+        static inline std::string_view str(char const* ptr) noexcept {
+            return ptr ? std::string_view { ptr } : std::string_view {};
+        }
+
+        static std::string_view name(Path const& path) noexcept;
+        static std::string_view name(Track const& track) noexcept;
+        static std::string_view name(Event const& event) noexcept;
+        static std::string_view name(EventData const& eventData) noexcept;
+        static std::string_view name(Clip const& clip) noexcept;
+
+        static std::span<TransitionClip::To const> transitions(TransitionClip const& transitionClip) noexcept;
+        static std::span<float const> weights(Mask const& mask) noexcept;
+        static std::span<Mask::RawJointHash const> joint_hashes(Mask const& mask) noexcept;
+        static Mem::PtrSpan<EventData> events_data(Event const& event) noexcept;
+        static ClipData const& data_of(Clip const& clip) noexcept;
+        // Empty unless clip data is atomic and has updaters
+        static Mem::PtrSpan<Updater> updaters(ClipData const& clipData) noexcept;
+        static std::span<Processor const> processors(Updater const& updater) noexcept;
+        // Empty unless clip data is parallel and has flags
+        static std::span<uint32_t const> clip_flags(ClipData const& clipData) noexcept;
+    };
+}
+
+#endif // RITO_BLENDVIEW_HPP
@@ -0,0 +1,59 @@
+#include "bounds.hpp"
+#include "simpleskin.hpp"
+
+using namespace Rito;
+
+namespace Rito::BoundsImpl {
+    // Box of an affine transformed box with column vector convention: p' = M * p
+    inline Box3D transform(Mtx44 const& m, Box3D const& box) noexcept {
+        auto const c = std::array<float, 3> {
+            (box.min.x + box.max.x) * 0.5f,
+            (box.min.y + box.max.y) * 0.5f,
+            (box.min.z + box.max.z) * 0.5f,
+        };
+        auto const e = std::array<float, 3> {
+            (box.max.x - box.min.x) * 0.5f,
+            (box.max.y - box.min.y) * 0.5f,
+            (box.max.z - box.min.z) * 0.5f,
+        };
+        auto center = std::array<float, 3> {};
+        auto extent = std::array<float, 3> {};
+        for(size_t r = 0; r != 3; r++) {
+            center[r] = m[r][0] * c[0] + m[r][1] * c[1] + m[r][2] * c[2] + m[r][3];
+            extent[r] = std::abs(m[r][0]) * e[0] + std::abs(m[r][1]) * e[1] + std::abs(m[r][2]) * e[2];
+        }
+        return {
+            { center[0] - extent[0], center[1] - extent[1], center[2] - extent[2] },
+            { center[0] + extent[0], center[1] + extent[1], center[2] + extent[2] },
+        };
+    }
+}
+
+JointBounds::JointBounds(SimpleSkin const& skn, size_t jointCount, float minWeight) {
+    auto const count = skn.vtxPositions.size();
+    file_assert(skn.vtxBlendIndices.size() == count && skn.vtxBlendWeights.size() == count);
+    boxes.resize(jointCount, EmptyBox3D());
+    for(size_t i = 0; i != count; i++) {
+        auto const& position = skn.vtxPositions[i];
+        auto const& indices = skn.vtxBlendIndices[i];
+        auto const& weights = skn.vtxBlendWeights[i];
+        for(size_t k = 0; k != 4; k++) {
+            if(weights[k] <= minWeight) {
+                continue;
+            }
+            file_assert(indices[k] < jointCount);
+            Expand(boxes[indices[k]], position);
+        }
+    }
+}
+
+Box3D JointBounds::animated(std::vector<Mtx44> const& matrices) const {
+    file_assert(matrices.size() >= boxes.size());
+    auto result = EmptyBox3D();
+    for(size_t j = 0; j != boxes.size(); j++) {
+        if(!IsEmpty(boxes[j])) {
+            Expand(result, BoundsImpl::transform(matrices[j], boxes[j]));
+        }
+    }
+    return result;
+}
@@ -0,0 +1,79 @@
+#ifndef RITO_BOUNDS_HPP
+#define RITO_BOUNDS_HPP
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "types.hpp"
+
+namespace Rito {
+    struct SimpleSkin;
+
+    // Empty box has min > max
+    inline constexpr Box3D EmptyBox3D() noexcept {
+        auto constexpr inf = std::numeric_limits<float>::infinity();
+        return { { inf, inf, inf }, { -inf, -inf, -inf } };
+    }
+
+    inline constexpr bool IsEmpty(Box3D const& box) noexcept {
+        return box.min.x > box.max.x || box.min.y > box.max.y || box.min.z > box.max.z;
+    }
+
+    inline constexpr void Expand(Box3D& box, Vec3 const& p) noexcept {
+        box.min = { std::min(box.min.x, p.x), std::min(box.min.y, p.y), std::min(box.min.z, p.z) };
+        box.max = { std::max(box.max.x, p.x), std::max(box.max.y, p.y), std::max(box.max.z, p.z) };
+    }
+
+    inline constexpr void Expand(Box3D& box, Box3D const& other) noexcept {
+        Expand(box, other.min);
+        Expand(box, other.max);
+    }
+
+    // Works with any range of Vec3, including Mem::Strided views
+    template<typename R>
+    inline Box3D ComputeBoundingBox(R const& positions) noexcept {
+        auto box = EmptyBox3D();
+        for(Vec3 const& p: positions) {
+            Expand(box, p);
+        }
+        return box;
+    }
+
+    // Centered on the box, radius reaches the farthest position
+    template<typename R>
+    inline Sphere ComputeBoundingSphere(R const& positions, Box3D const& box) noexcept {
+        if(IsEmpty(box)) {
+            return {};
+        }
+        auto const center = Vec3 {
+            (box.min.x + box.max.x) * 0.5f,
+            (box.min.y + box.max.y) * 0.5f,
+            (box.min.z + box.max.z) * 0.5f,
+        };
+        auto radius2 = 0.0f;
+        for(Vec3 const& p: positions) {
+            auto const x = p.x - center.x;
+            auto const y = p.y - center.y;
+            auto const z = p.z - center.z;
+            radius2 = std::max(radius2, x * x + y * y + z * z);
+        }
+        return { center, std::sqrt(radius2) };
+    }
+
+    // Bind space box of the vertices influenced by each joint.
+    // A skinned vertex is a weighted average of its joint transformed positions, so the
+    // union of every joint box transformed by its skin matrix bounds the posed mesh.
+    struct JointBounds {
+        std::vector<Box3D> boxes;
+
+        JointBounds() noexcept = default;
+        // Influences with weight at or below minWeight are ignored
+        JointBounds(SimpleSkin const& skn, size_t jointCount, float minWeight = 0.0f);
+
+        // Matrices as returned by SkinMatrices, costs O(joints)
+        Box3D animated(std::vector<Mtx44> const& matrices) const;
+    };
+}
+
+#endif // RITO_BOUNDS_HPP
@@ -0,0 +1,278 @@
+#include <algorithm>
+#include "bvh.hpp"
+
+using namespace Rito;
+
+namespace Rito::BvhImpl {
+    constexpr uint32_t leafSize = 4;
+    constexpr uint32_t binCount = 16;
+    constexpr size_t stackSize = 64;
+    // Past this depth splits fall back to median so traversal stack can never overflow
+    constexpr uint32_t maxSahDepth = 32;
+
+    struct Item {
+        Box3D box;
+        Vec3 center;
+        uint32_t index;
+    };
+
+    struct Bin {
+        Box3D box = empty();
+        uint32_t count = 0;
+
+        static inline constexpr Box3D empty() noexcept {
+            constexpr auto inf = std::numeric_limits<float>::infinity();
+            return { { inf, inf, inf }, { -inf, -inf, -inf } };
+        }
+    };
+
+    inline float axis(Vec3 const& v, int a) noexcept {
+        return a == 0 ? v.x : (a == 1 ? v.y : v.z);
+    }
+
+    inline void grow(Box3D& box, Box3D const& other) noexcept {
+        box.min = { std::min(box.min.x, other.min.x), std::min(box.min.y, other.min.y), std::min(box.min.z, other.min.z) };
+        box.max = { std::max(box.max.x, other.max.x), std::max(box.max.y, other.max.y), std::max(box.max.z, other.max.z) };
+    }
+
+    inline void grow(Box3D& box, Vec3 const& point) noexcept {
+        grow(box, Box3D { point, point });
+    }
+
+    inline float area(Box3D const& box) noexcept {
+        auto const x = box.max.x - box.min.x;
+        auto const y = box.max.y - box.min.y;
+        auto const z = box.max.z - box.min.z;
+        if(x < 0.0f || y < 0.0f || z < 0.0f) {
+            return 0.0f;
+        }
+        return x * y + y * z + z * x;
+    }
+
+    inline bool overlaps(Box3D const& a, Box3D const& b) noexcept {
+        return a.min.x <= b.max.x && a.max.x >= b.min.x
+                && a.min.y <= b.max.y && a.max.y >= b.min.y
+                && a.min.z <= b.max.z && a.max.z >= b.min.z;
+    }
+
+    inline bool overlaps(Frustum const& frustum, Box3D const& box) noexcept {
+        for(auto const& p: frustum.planes) {
+            auto const x = p.x >= 0.0f ? box.max.x : box.min.x;
+            auto const y = p.y >= 0.0f ? box.max.y : box.min.y;
+            auto const z = p.z >= 0.0f ? box.max.z : box.min.z;
+            if(p.x * x + p.y * y + p.z * z + p.w < 0.0f) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline bool overlaps(Ray const& ray, Vec3 const& invDir, Box3D const& box) noexcept {
+        auto tmin = 0.0f;
+        auto tmax = ray.maxDistance;
+        for(int a = 0; a < 3; a++) {
+            auto const o = axis(ray.origin, a);
+            auto const d = axis(invDir, a);
+            auto t0 = (axis(box.min, a) - o) * d;
+            auto t1 = (axis(box.max, a) - o) * d;
+            if(t0 > t1) {
+                std::swap(t0, t1);
+            }
+            // NaN (0 * inf on a slab boundary) leaves tmin/tmax untouched
+            tmin = t0 > tmin ? t0 : tmin;
+            tmax = t1 < tmax ? t1 : tmax;
+            if(tmin > tmax) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    struct Builder {
+        std::vector<Item> items;
+        std::vector<Bvh::Node>& nodes;
+
+        void build(uint32_t begin, uint32_t end, uint32_t depth) {
+            auto const nodeIndex = static_cast<uint32_t>(nodes.size());
+            auto& node = nodes.emplace_back();
+            auto bounds = Bin::empty();
+            auto centers = Bin::empty();
+            for(auto i = begin; i != end; i++) {
+                grow(bounds, items[i].box);
+                grow(centers, items[i].center);
+            }
+            node.box = bounds;
+
+            auto const count = end - begin;
+            if(count <= leafSize) {
+                make_leaf(nodeIndex, begin, count);
+                return;
+            }
+
+            auto bestAxis = -1;
+            auto bestSplit = 0u;
+            auto bestCost = area(bounds) * static_cast<float>(count);
+            for(int a = 0; a < 3 && depth < maxSahDepth; a++) {
+                auto const lo = axis(centers.min, a);
+                auto const hi = axis(centers.max, a);
+                if(!(hi > lo)) {
+                    continue;
+                }
+                std::array<Bin, binCount> bins = {};
+                auto const scale = static_cast<float>(binCount) / (hi - lo);
+                for(auto i = begin; i != end; i++) {
+                    auto& bin = bins[bin_index(axis(items[i].center, a), lo, scale)];
+                    grow(bin.box, items[i].box);
+                    bin.count++;
+                }
+                std::array<float, binCount - 1> rightCost = {};
+                auto rightBox = Bin::empty();
+                auto rightCount = 0u;
+                for(auto b = binCount - 1; b > 0; b--) {
+                    grow(rightBox, bins[b].box);
+                    rightCount += bins[b].count;
+                    rightCost[b - 1] = area(rightBox) * static_cast<float>(rightCount);
+                }
+                auto leftBox = Bin::empty();
+                auto leftCount = 0u;
+                for(auto b = 0u; b < binCount - 1; b++) {
+                    grow(leftBox, bins[b].box);
+                    leftCount += bins[b].count;
+                    auto const cost = area(leftBox) * static_cast<float>(leftCount) + rightCost[b];
+                    if(leftCount != 0 && leftCount != count && cost < bestCost) {
+                        bestCost = cost;
+                        bestAxis = a;
+                        bestSplit = b;
+                    }
+                }
+            }
+
+            auto middle = begin + count / 2;
+            if(bestAxis != -1) {
+                auto const lo = axis(centers.min, bestAxis);
+                auto const scale = static_cast<float>(binCount) / (axis(centers.max, bestAxis) - lo);
+                auto const split = std::partition(items.begin() + begin, items.begin() + end,
+                                                  [&](Item const& item) {
+                    return bin_index(axis(item.center, bestAxis), lo, scale) <= bestSplit;
+                });
+                middle = static_cast<uint32_t>(split - items.begin());
+            } else if(count <= leafSize * 4 && depth < maxSahDepth) {
+                make_leaf(nodeIndex, begin, count);
+                return;
+            } else {
+                // Splitting costs more than it saves but leaf would be too large, fall back to median
+                auto const a = centers.max.x - centers.min.x >= centers.max.y - centers.min.y
+                        ? (centers.max.x - centers.min.x >= centers.max.z - centers.min.z ? 0 : 2)
+                        : (centers.max.y - centers.min.y >= centers.max.z - centers.min.z ? 1 : 2);
+                std::nth_element(items.begin() + begin, items.begin() + middle, items.begin() + end,
+                                 [a](Item const& l, Item const& r) {
+                    return axis(l.center, a) < axis(r.center, a);
+                });
+            }
+
+            build(begin, middle, depth + 1);
+            nodes[nodeIndex].first = static_cast<uint32_t>(nodes.size());
+            nodes[nodeIndex].count = 0;
+            build(middle, end, depth + 1);
+        }
+
+        static inline uint32_t bin_index(float value, float lo, float scale) noexcept {
+            auto const b = static_cast<uint32_t>((value - lo) * scale);
+            return std::min(b, binCount - 1);
+        }
+
+        inline void make_leaf(uint32_t nodeIndex, uint32_t begin, uint32_t count) noexcept {
+            nodes[nodeIndex].first = begin;
+            nodes[nodeIndex].count = count;
+        }
+    };
+
+    template<typename F>
+    inline void traverse(Bvh const& bvh, F&& overlap, std::vector<uint32_t>& result) {
+        if(bvh.nodes.empty()) {
+            return;
+        }
+        std::array<uint32_t, stackSize> stack;
+        size_t top = 0;
+        stack[top++] = 0;
+        while(top != 0) {
+            auto const& node = bvh.nodes[stack[--top]];
+            if(!overlap(node.box)) {
+                continue;
+            }
+            if(node.count != 0) {
+                for(auto i = node.first; i != node.first + node.count; i++) {
+                    if(overlap(bvh.boxes[i])) {
+                        result.push_back(bvh.items[i]);
+                    }
+                }
+                continue;
+            }
+            auto const left = static_cast<uint32_t>(&node - bvh.nodes.data()) + 1;
+            stack[top++] = node.first;
+            stack[top++] = left;
+        }
+    }
+}
+
+Bvh::Bvh(std::vector<Box3D> const& bounds) {
+    using namespace Rito::BvhImpl;
+    if(bounds.empty()) {
+        return;
+    }
+    auto builder = Builder { {}, nodes };
+    builder.items.reserve(bounds.size());
+    for(size_t i = 0; i != bounds.size(); i++) {
+        auto const& box = bounds[i];
+        builder.items.push_back({
+                                    box,
+                                    {
+                                        (box.min.x + box.max.x) * 0.5f,
+                                        (box.min.y + box.max.y) * 0.5f,
+                                        (box.min.z + box.max.z) * 0.5f
+                                    },
+                                    static_cast<uint32_t>(i)
+                                });
+    }
+    nodes.reserve(bounds.size() * 2 / leafSize + 1);
+    builder.build(0, static_cast<uint32_t>(bounds.size()), 0);
+
+    items.reserve(bounds.size());
+    boxes.reserve(bounds.size());
+    for(auto const& item: builder.items) {
+        items.push_back(item.index);
+        boxes.push_back(item.box);
+    }
+    nodes.shrink_to_fit();
+}
+
+Bvh::Bvh(MapGeo const& map) : Bvh([&map] {
+    std::vector<Box3D> boxes;
+    boxes.reserve(map.meshInfos.size());
+    for(auto const& meshInfo: map.meshInfos) {
+        boxes.push_back(meshInfo.boundingBox);
+    }
+    return boxes;
+}()) {}
+
+void Bvh::query(Box3D const& box, std::vector<uint32_t>& result) const {
+    using namespace Rito::BvhImpl;
+    traverse(*this, [&box](Box3D const& node) {
+        return overlaps(box, node);
+    }, result);
+}
+
+void Bvh::query(Frustum const& frustum, std::vector<uint32_t>& result) const {
+    using namespace Rito::BvhImpl;
+    traverse(*this, [&frustum](Box3D const& node) {
+        return overlaps(frustum, node);
+    }, result);
+}
+
+void Bvh::query(Ray const& ray, std::vector<uint32_t>& result) const {
+    using namespace Rito::BvhImpl;
+    auto const invDir = Vec3 { 1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z };
+    traverse(*this, [&ray, &invDir](Box3D const& node) {
+        return overlaps(ray, invDir, node);
+    }, result);
+}
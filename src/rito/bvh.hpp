@@ -0,0 +1,45 @@
+#ifndef RITO_BVH_HPP
+#define RITO_BVH_HPP
+#include <cinttypes>
+#include <vector>
+#include <limits>
+#include "types.hpp"
+#include "mapgeo.hpp"
+
+namespace Rito {
+    struct Frustum {
+        // Plane normal in xyz, distance in w, inside is where dot(normal, point) + w >= 0
+        std::array<Vec4, 6> planes;
+    };
+
+    struct Ray {
+        Vec3 origin;
+        Vec3 direction;
+        float maxDistance = std::numeric_limits<float>::infinity();
+    };
+
+    struct Bvh {
+        struct Node {
+            Box3D box;
+            // Leaf: first index into items, inner: index of right child (left child is next node)
+            uint32_t first;
+            // Number of items in leaf, 0 for inner nodes
+            uint32_t count;
+        };
+        std::vector<Node> nodes = {};
+        // Indices of input boxes in leaf order
+        std::vector<uint32_t> items = {};
+        std::vector<Box3D> boxes = {};
+
+        Bvh() noexcept = default;
+        Bvh(std::vector<Box3D> const& bounds);
+        // Indexes MapGeo::meshInfos by their bounding boxes
+        Bvh(MapGeo const& map);
+
+        void query(Box3D const& box, std::vector<uint32_t>& result) const;
+        void query(Frustum const& frustum, std::vector<uint32_t>& result) const;
+        void query(Ray const& ray, std::vector<uint32_t>& result) const;
+    };
+}
+
+#endif // RITO_BVH_HPP
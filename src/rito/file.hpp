@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <stdexcept>
 #include <array>
+#include "stringpool.hpp"
 
 #define file_assert(what) do { if(!(what)) { throw ::Rito::FileError(#what); } } while(false)
 
@@ -51,6 +52,9 @@ namespace Rito {
     template<int32_t S>
     inline constexpr size_fixed_t<S> size_fixed = {};
 
+    struct lazy_t {};
+    inline constexpr lazy_t lazy = {};
+
     struct BaseResource {
         int32_t resourceSize;
     };
@@ -128,6 +132,9 @@ namespace Rito {
     template<typename T>
     using RelPtrArr = RelPtr<RelPtr<T>>;
 
+    template<typename T>
+    struct LazyArr;
+
     struct File {
     private:
         void* file = {};
@@ -205,6 +212,21 @@ namespace Rito {
             raw_read(value.data(), sizeof(T), count);
         }
 
+        template<typename T>
+        inline void read(LazyArr<T>& value, int32_t count) const {
+            value.offset = tell();
+            value.count = count;
+            read(value.items, count);
+        }
+
+        template<typename T>
+        inline void read(LazyArr<T>& value, int32_t count, lazy_t) const {
+            check_size<T>(count);
+            value.offset = tell();
+            value.count = count;
+            seek_cur(count * static_cast<int32_t>(sizeof(T)));
+        }
+
         template<typename T, typename P>
         inline void read(std::vector<T>& value, size_prefix_t<P>) const {
             auto const size = get<P>();
@@ -249,5 +271,24 @@ namespace Rito {
             value = data.data();
         }
     };
+
+    // Array that only remembers where it lives in the file until first requested
+    template<typename T>
+    struct LazyArr {
+        int32_t offset = {};
+        int32_t count = {};
+        std::vector<T> items = {};
+
+        inline bool loaded() const noexcept {
+            return items.size() == static_cast<size_t>(count);
+        }
+
+        inline std::vector<T> const& get(File const& file) {
+            if(!loaded()) {
+                file.read(items, Offset<T> { offset }, count);
+            }
+            return items;
+        }
+    };
 }
 #endif // RITO_FILE_HPP
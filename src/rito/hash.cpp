@@ -0,0 +1,43 @@
+#include "hash.hpp"
+#include "parallel.hpp"
+
+using namespace Rito;
+
+namespace Rito::HashImpl {
+    // Names are independent so out of order execution already overlaps consecutive hashes,
+    // only batches large enough to pay for thread startup are split up
+    template<typename H, typename F>
+    inline void batch(std::span<std::string_view const> names, std::span<H> out, F&& hash) {
+        constexpr size_t grain = 16 * 1024;
+        if(names.size() < 4 * grain) {
+            for(size_t i = 0; i != names.size(); i++) {
+                out[i] = hash(names[i]);
+            }
+            return;
+        }
+        parallel_for((names.size() + grain - 1) / grain, [&](size_t chunk) {
+            auto const end = std::min(names.size(), (chunk + 1) * grain);
+            for(auto i = chunk * grain; i != end; i++) {
+                out[i] = hash(names[i]);
+            }
+        });
+    }
+}
+
+void Rito::ElfHash(std::span<std::string_view const> names, std::span<uint32_t> out) {
+    HashImpl::batch(names, out, [](std::string_view name) {
+        return ElfHash(name);
+    });
+}
+
+void Rito::Fnv1aHash(std::span<std::string_view const> names, std::span<uint32_t> out) {
+    HashImpl::batch(names, out, [](std::string_view name) {
+        return Fnv1aHash(name);
+    });
+}
+
+void Rito::XXHash64(std::span<std::string_view const> names, std::span<uint64_t> out, uint64_t seed) {
+    HashImpl::batch(names, out, [seed](std::string_view name) {
+        return XXHash64(name, seed);
+    });
+}
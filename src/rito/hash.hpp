@@ -0,0 +1,162 @@
+#ifndef RITO_HASH_HPP
+#define RITO_HASH_HPP
+#include <cinttypes>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <string_view>
+
+// Hashes of names and paths as the game computes them, input is lower cased first.
+// Everything is constexpr so hash literals are compile time constants.
+namespace Rito {
+    namespace HashImpl {
+        inline constexpr auto lowerCase = [] {
+            std::array<uint8_t, 256> table = {};
+            for(size_t c = 0; c != 256; c++) {
+                table[c] = static_cast<uint8_t>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+            }
+            return table;
+        }();
+
+        inline constexpr uint8_t lower(char c) noexcept {
+            return lowerCase[static_cast<uint8_t>(c)];
+        }
+
+        inline constexpr uint32_t elf_step(uint32_t h, char c) noexcept {
+            h = (h << 4) + lower(c);
+            auto const high = h & 0xF0000000;
+            return (h ^ (high >> 24)) & ~high;
+        }
+
+        inline constexpr uint32_t fnv1a_step(uint32_t h, char c) noexcept {
+            return (h ^ lower(c)) * 0x01000193u;
+        }
+
+        inline constexpr uint64_t xxPrime1 = 0x9E3779B185EBCA87ull;
+        inline constexpr uint64_t xxPrime2 = 0xC2B2AE3D27D4EB4Full;
+        inline constexpr uint64_t xxPrime3 = 0x165667B19E3779F9ull;
+        inline constexpr uint64_t xxPrime4 = 0x85EBCA77C2B2AE63ull;
+        inline constexpr uint64_t xxPrime5 = 0x27D4EB2F165667C5ull;
+
+        inline constexpr uint64_t rotl(uint64_t value, int bits) noexcept {
+            return (value << bits) | (value >> (64 - bits));
+        }
+
+        // Lower cases 8 ascii letters at once, bytes with the high bit set are left alone
+        inline constexpr uint64_t lower_swar(uint64_t value) noexcept {
+            constexpr auto ones = 0x0101010101010101ull;
+            auto const low = value & (ones * 0x7F);
+            auto const aboveA = low + ones * (0x80 - 'A');
+            auto const aboveZ = low + ones * (0x80 - 'Z' - 1);
+            auto const upper = aboveA & ~aboveZ & ~value & (ones * 0x80);
+            return value | (upper >> 2);
+        }
+
+        // Little endian regardless of host
+        template<size_t N>
+        inline constexpr uint64_t read_lower(char const* data) noexcept {
+            if(!std::is_constant_evaluated() && std::endian::native == std::endian::little) {
+                uint64_t value = 0;
+                std::memcpy(&value, data, N);
+                return lower_swar(value);
+            }
+            uint64_t value = 0;
+            for(size_t i = 0; i != N; i++) {
+                value |= static_cast<uint64_t>(lower(data[i])) << (i * 8);
+            }
+            return value;
+        }
+
+        inline constexpr uint64_t xx_round(uint64_t acc, uint64_t input) noexcept {
+            return rotl(acc + input * xxPrime2, 31) * xxPrime1;
+        }
+
+        inline constexpr uint64_t xx_merge(uint64_t acc, uint64_t value) noexcept {
+            return (acc ^ xx_round(0, value)) * xxPrime1 + xxPrime4;
+        }
+    }
+
+    inline constexpr uint32_t ElfHash(std::string_view view) noexcept {
+        uint32_t h = 0;
+        for(auto const c: view) {
+            h = HashImpl::elf_step(h, c);
+        }
+        return h;
+    }
+
+    // 32-bit FNV-1a, used for bin class, field and entry names
+    inline constexpr uint32_t Fnv1aHash(std::string_view view) noexcept {
+        uint32_t h = 0x811C9DC5u;
+        for(auto const c: view) {
+            h = HashImpl::fnv1a_step(h, c);
+        }
+        return h;
+    }
+
+    // XXH64, used for archive paths
+    inline constexpr uint64_t XXHash64(std::string_view view, uint64_t seed = 0) noexcept {
+        using namespace HashImpl;
+        auto data = view.data();
+        auto const size = view.size();
+        auto const end = data + size;
+        uint64_t h = 0;
+        if(size >= 32) {
+            uint64_t v1 = seed + xxPrime1 + xxPrime2;
+            uint64_t v2 = seed + xxPrime2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - xxPrime1;
+            for(; end - data >= 32; data += 32) {
+                v1 = xx_round(v1, read_lower<8>(data));
+                v2 = xx_round(v2, read_lower<8>(data + 8));
+                v3 = xx_round(v3, read_lower<8>(data + 16));
+                v4 = xx_round(v4, read_lower<8>(data + 24));
+            }
+            h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+            h = xx_merge(h, v1);
+            h = xx_merge(h, v2);
+            h = xx_merge(h, v3);
+            h = xx_merge(h, v4);
+        } else {
+            h = seed + xxPrime5;
+        }
+        h += size;
+        for(; end - data >= 8; data += 8) {
+            h = rotl(h ^ xx_round(0, read_lower<8>(data)), 27) * xxPrime1 + xxPrime4;
+        }
+        if(end - data >= 4) {
+            h = rotl(h ^ (read_lower<4>(data) * xxPrime1), 23) * xxPrime2 + xxPrime3;
+            data += 4;
+        }
+        for(; data != end; data++) {
+            h = rotl(h ^ (lower(*data) * xxPrime5), 11) * xxPrime1;
+        }
+        h ^= h >> 33;
+        h *= xxPrime2;
+        h ^= h >> 29;
+        h *= xxPrime3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    // Hash many names at once, out must be at least as large as names. Large batches are spread over threads.
+    void ElfHash(std::span<std::string_view const> names, std::span<uint32_t> out);
+    void Fnv1aHash(std::span<std::string_view const> names, std::span<uint32_t> out);
+    void XXHash64(std::span<std::string_view const> names, std::span<uint64_t> out, uint64_t seed = 0);
+
+    static_assert(HashImpl::lower_swar(0x405A5B617A41C1DAull) == 0x407A5B617A61C1DAull);
+    static_assert(ElfHash("") == 0);
+    static_assert(ElfHash("Root") == 0x00079664u);
+    static_assert(ElfHash("L_Clavicle_Long_Joint_Name") == 0x0CD9B945u);
+    static_assert(Fnv1aHash("") == 0x811C9DC5u);
+    static_assert(Fnv1aHash("a") == 0xE40C292Cu);
+    static_assert(Fnv1aHash("FOOBAR") == 0xBF9CF968u);
+    static_assert(XXHash64("") == 0xEF46DB3751D8E999ull);
+    static_assert(XXHash64("a") == 0xD24EC4F1A98C6E5Bull);
+    static_assert(XXHash64("abc") == 0x44BC2CF5AD770999ull);
+    static_assert(XXHash64("data/characters/ashe/ashe.bin") == 0xF9E6AF337FD69EC8ull);
+    static_assert(XXHash64("ASSETS/Characters/Ashe/Skins/Base/Ashe_Base_TX_CM.dds") == 0x84C250524387F7D2ull);
+}
+
+#endif // RITO_HASH_HPP
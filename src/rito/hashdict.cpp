@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include "hashdict.hpp"
+#include "parallel.hpp"
+#include "file.hpp"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace Rito;
+
+struct HashDictionary::Mapping {
+    char const* data = {};
+    size_t size = {};
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = {};
+
+    Mapping(char const* path) {
+        file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        file_assert(file != INVALID_HANDLE_VALUE);
+        LARGE_INTEGER fileSize = {};
+        if(!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            file_assert(!"Failed to get size of hash list");
+        }
+        size = static_cast<size_t>(fileSize.QuadPart);
+        if(size == 0) {
+            return;
+        }
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        auto const view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if(!view) {
+            this->~Mapping();
+            file_assert(!"Failed to map hash list");
+        }
+        data = static_cast<char const*>(view);
+    }
+
+    ~Mapping() noexcept {
+        if(data) {
+            UnmapViewOfFile(data);
+        }
+        if(mapping) {
+            CloseHandle(mapping);
+        }
+        if(file != INVALID_HANDLE_VALUE) {
+            CloseHandle(file);
+        }
+    }
+#else
+    Mapping(char const* path) {
+        auto const fd = open(path, O_RDONLY);
+        file_assert(fd != -1);
+        struct stat info = {};
+        if(fstat(fd, &info) != 0) {
+            close(fd);
+            file_assert(!"Failed to get size of hash list");
+        }
+        size = static_cast<size_t>(info.st_size);
+        if(size == 0) {
+            close(fd);
+            return;
+        }
+        auto const view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        file_assert(view != MAP_FAILED);
+        madvise(view, size, MADV_SEQUENTIAL);
+        data = static_cast<char const*>(view);
+    }
+
+    ~Mapping() noexcept {
+        if(data) {
+            munmap(const_cast<char*>(data), size);
+        }
+    }
+#endif
+    Mapping(Mapping const&) = delete;
+    Mapping& operator=(Mapping const&) = delete;
+};
+
+namespace Rito::HashDictionaryImpl {
+    struct Line {
+        uint64_t hash;
+        // Start of the name, mapping base included
+        uint32_t offset;
+    };
+
+    // 0-15 for hex digits, 0xFF for everything else
+    constexpr auto hexDigits = [] {
+        std::array<uint8_t, 256> table = {};
+        for(auto& value: table) {
+            value = 0xFF;
+        }
+        for(int c = 0; c != 10; c++) {
+            table['0' + c] = static_cast<uint8_t>(c);
+        }
+        for(int c = 0; c != 6; c++) {
+            table['a' + c] = table['A' + c] = static_cast<uint8_t>(10 + c);
+        }
+        return table;
+    }();
+
+    // Lines that do not start with a hex hash followed by a space are skipped
+    inline void parse(char const* base, char const* begin, char const* end, uint32_t baseOffset, std::vector<Line>& lines) {
+        while(begin != end) {
+            auto lineEnd = static_cast<char const*>(memchr(begin, '\n', static_cast<size_t>(end - begin)));
+            auto const next = lineEnd ? lineEnd + 1 : end;
+            lineEnd = lineEnd ? lineEnd : end;
+            if(lineEnd != begin && lineEnd[-1] == '\r') {
+                lineEnd--;
+            }
+            uint64_t hash = 0;
+            auto c = begin;
+            for(; c != lineEnd && c - begin < 16; c++) {
+                auto const digit = hexDigits[static_cast<uint8_t>(*c)];
+                if(digit == 0xFF) {
+                    break;
+                }
+                hash = (hash << 4) | digit;
+            }
+            if(c != begin && c != lineEnd && *c == ' ') {
+                lines.push_back({ hash, baseOffset + static_cast<uint32_t>(c + 1 - base) });
+            }
+            begin = next;
+        }
+    }
+
+    // Stable LSD radix sort on hash, byte positions where every hash agrees are skipped
+    inline void sort_by_hash(std::vector<Line>& lines) {
+        std::vector<Line> scratch(lines.size());
+        std::array<std::array<size_t, 256>, 8> counts = {};
+        for(auto const& line: lines) {
+            for(size_t b = 0; b != 8; b++) {
+                counts[b][(line.hash >> (b * 8)) & 0xFF]++;
+            }
+        }
+        for(size_t b = 0; b != 8; b++) {
+            auto& count = counts[b];
+            if(std::find(count.begin(), count.end(), lines.size()) != count.end()) {
+                continue;
+            }
+            size_t sum = 0;
+            for(auto& c: count) {
+                sum += std::exchange(c, sum);
+            }
+            for(auto const& line: lines) {
+                scratch[count[(line.hash >> (b * 8)) & 0xFF]++] = line;
+            }
+            lines.swap(scratch);
+        }
+    }
+}
+
+HashDictionary::HashDictionary() noexcept = default;
+
+HashDictionary::HashDictionary(char const* path) {
+    load(path);
+}
+
+HashDictionary::HashDictionary(HashDictionary&&) noexcept = default;
+
+HashDictionary& HashDictionary::operator=(HashDictionary&&) noexcept = default;
+
+HashDictionary::~HashDictionary() noexcept = default;
+
+void HashDictionary::load(char const* path) {
+    using namespace Rito::HashDictionaryImpl;
+    auto const baseOffset = bases.empty() ? size_t {} : bases.back() + mappings.back()->size;
+    auto mapping = std::make_unique<Mapping>(path);
+    file_assert(baseOffset + mapping->size <= std::numeric_limits<uint32_t>::max());
+    auto const base = static_cast<uint32_t>(baseOffset);
+
+    // Chunks split on line boundaries are parsed in parallel then merged in file order
+    constexpr size_t chunkSize = 1024 * 1024;
+    auto const begin = mapping->data;
+    auto const end = mapping->data + mapping->size;
+    std::vector<char const*> bounds = { begin };
+    while(static_cast<size_t>(end - bounds.back()) > chunkSize) {
+        auto const split = static_cast<char const*>(memchr(bounds.back() + chunkSize, '\n', static_cast<size_t>(end - bounds.back() - chunkSize)));
+        if(!split) {
+            break;
+        }
+        bounds.push_back(split + 1);
+    }
+    bounds.push_back(end);
+
+    std::vector<std::vector<Line>> chunks(bounds.size() - 1);
+    parallel_for(chunks.size(), [&](size_t i) {
+        // Rough guess at the average line length
+        chunks[i].reserve(static_cast<size_t>(bounds[i + 1] - bounds[i]) / 32);
+        parse(begin, bounds[i], bounds[i + 1], base, chunks[i]);
+    });
+
+    size_t total = hashes.size();
+    for(auto const& chunk: chunks) {
+        total += chunk.size();
+    }
+    std::vector<Line> lines;
+    lines.reserve(total);
+    for(size_t i = 0; i != hashes.size(); i++) {
+        lines.push_back({ hashes[i], offsets[i] });
+    }
+    for(auto& chunk: chunks) {
+        lines.insert(lines.end(), chunk.begin(), chunk.end());
+        chunk = {};
+    }
+
+    // Known names come first and new ones follow in file order, a stable sort keeps the first name of a hash first
+    sort_by_hash(lines);
+    lines.erase(std::unique(lines.begin(), lines.end(), [](Line const& l, Line const& r) {
+        return l.hash == r.hash;
+    }), lines.end());
+    hashes.resize(lines.size());
+    offsets.resize(lines.size());
+    for(size_t i = 0; i != lines.size(); i++) {
+        hashes[i] = lines[i].hash;
+        offsets[i] = lines[i].offset;
+    }
+    hashes.shrink_to_fit();
+    offsets.shrink_to_fit();
+    mappings.push_back(std::move(mapping));
+    bases.push_back(base);
+}
+
+std::string_view HashDictionary::find(uint64_t hash) const noexcept {
+    auto const found = std::lower_bound(hashes.begin(), hashes.end(), hash);
+    if(found == hashes.end() || *found != hash) {
+        return {};
+    }
+    auto const offset = offsets[static_cast<size_t>(found - hashes.begin())];
+    auto const m = static_cast<size_t>(std::upper_bound(bases.begin(), bases.end(), offset) - bases.begin()) - 1;
+    auto const& mapping = *mappings[m];
+    auto const name = mapping.data + (offset - bases[m]);
+    auto const end = mapping.data + mapping.size;
+    auto lineEnd = static_cast<char const*>(memchr(name, '\n', static_cast<size_t>(end - name)));
+    lineEnd = lineEnd ? lineEnd : end;
+    if(lineEnd != name && lineEnd[-1] == '\r') {
+        lineEnd--;
+    }
+    return { name, static_cast<size_t>(lineEnd - name) };
+}
+
+size_t HashDictionary::size() const noexcept {
+    return hashes.size();
+}
+
+size_t HashDictionary::resolve(Animation& animation) const {
+    animation.strings = StringPool::shared_or_new(std::move(animation.strings));
+    size_t count = 0;
+    for(auto& track: animation.tracks) {
+        if(!track.name.empty()) {
+            continue;
+        }
+        if(auto const name = find(track.boneHash); !name.empty()) {
+            track.name = animation.strings->intern(name);
+            count++;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,41 @@
+#ifndef RITO_HASHDICT_HPP
+#define RITO_HASHDICT_HPP
+#include <cinttypes>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "animation.hpp"
+
+namespace Rito {
+    // Names for hashes out of text lists with one "<hex hash> <name>" per line.
+    // Lists are memory mapped and stay mapped, names are views into them.
+    // Per name only its hash and where it starts in the list are kept, 12 bytes sorted by hash.
+    struct HashDictionary {
+        HashDictionary() noexcept;
+        HashDictionary(char const* path);
+        HashDictionary(HashDictionary&&) noexcept;
+        HashDictionary& operator=(HashDictionary&&) noexcept;
+        ~HashDictionary() noexcept;
+
+        // Adds another list, hashes already known keep their first name
+        void load(char const* path);
+
+        // Empty when hash is unknown
+        std::string_view find(uint64_t hash) const noexcept;
+
+        size_t size() const noexcept;
+
+        // Fills in names of tracks that only carry a bone hash, returns how many were named
+        size_t resolve(Animation& animation) const;
+    private:
+        struct Mapping;
+        std::vector<std::unique_ptr<Mapping>> mappings;
+        // Where each mapping starts when all of them are laid end to end
+        std::vector<uint32_t> bases;
+        // Sorted, offsets[i] is where the name of hashes[i] starts in the mappings laid end to end
+        std::vector<uint64_t> hashes;
+        std::vector<uint32_t> offsets;
+    };
+}
+
+#endif // RITO_HASHDICT_HPP
@@ -0,0 +1,103 @@
+#ifndef RITO_HASHINDEX_HPP
+#define RITO_HASHINDEX_HPP
+#include <cinttypes>
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+namespace Rito {
+    // Open addressed map from integer ids, usually hashes, to indices into some array.
+    // Linear probing over a power of two table kept at most half full.
+    template<typename K = uint32_t>
+    struct HashIndex {
+        static constexpr uint32_t none = ~0u;
+
+        struct Slot {
+            K key;
+            uint32_t value = none;
+        };
+
+        std::vector<Slot> slots;
+        uint32_t count = {};
+
+        HashIndex() noexcept = default;
+
+        // Indexes items by key_of(item), when keys repeat the first item wins
+        template<typename R, typename F>
+        HashIndex(R const& items, F&& key_of) {
+            reserve(items.size());
+            uint32_t index = 0;
+            for(auto const& item: items) {
+                insert(key_of(item), index++);
+            }
+        }
+
+        inline void reserve(size_t capacity) {
+            auto const size = std::bit_ceil(std::max(capacity * 2, size_t { 8 }));
+            if(size <= slots.size()) {
+                return;
+            }
+            auto old = std::move(slots);
+            slots.assign(size, Slot {});
+            count = 0;
+            for(auto const& slot: old) {
+                if(slot.value != none) {
+                    insert(slot.key, slot.value);
+                }
+            }
+        }
+
+        // Returns false and keeps the old value when key is already present
+        inline bool insert(K key, uint32_t value) {
+            if((count + 1) * 2 > slots.size()) {
+                reserve(count + 1);
+            }
+            for(auto i = bucket(key);; i = (i + 1) & (slots.size() - 1)) {
+                auto& slot = slots[i];
+                if(slot.value == none) {
+                    slot = { key, value };
+                    count++;
+                    return true;
+                }
+                if(slot.key == key) {
+                    return false;
+                }
+            }
+        }
+
+        inline uint32_t find(K key) const noexcept {
+            if(slots.empty()) {
+                return none;
+            }
+            for(auto i = bucket(key);; i = (i + 1) & (slots.size() - 1)) {
+                auto const& slot = slots[i];
+                if(slot.value == none || slot.key == key) {
+                    return slot.value;
+                }
+            }
+        }
+
+        // Keeps the slots allocated
+        inline void clear() noexcept {
+            std::fill(slots.begin(), slots.end(), Slot {});
+            count = 0;
+        }
+
+        inline size_t size() const noexcept {
+            return count;
+        }
+
+        inline bool empty() const noexcept {
+            return count == 0;
+        }
+
+    private:
+        // Fibonacci hashing, ids are often hashes already but may also be small sequential numbers
+        inline size_t bucket(K key) const noexcept {
+            auto const h = static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull;
+            return static_cast<size_t>(h >> (64 - std::countr_zero(slots.size())));
+        }
+    };
+}
+
+#endif // RITO_HASHINDEX_HPP
@@ -1,4 +1,7 @@
+#include <cstring>
 #include "mapgeo.hpp"
+#include "memory.hpp"
+#include "parallel.hpp"
 
 using namespace Rito;
 
@@ -8,7 +11,107 @@ namespace Rito::MapGeoImpl {
         uint32_t version;
     };
 
-    void read(MapGeo& map, File const& file) {
+    template<typename T>
+    inline void read_buffer(LazyArr<T>& buffer, File const& file, int32_t count, bool lazy) {
+        if(lazy) {
+            file.read(buffer, count, Rito::lazy);
+        } else {
+            file.read(buffer, count);
+        }
+    }
+
+    void read_mesh_info(MapGeo::MeshInfo& meshInfo, Mem::Reader& reader, bool unkbool) {
+        reader.read(meshInfo.name, size_prefix<int32_t>);
+        reader.read(meshInfo.vertexCount);
+        auto const meshVtxBufferCount = reader.get<int32_t>();
+        reader.read(meshInfo.vertexElemGroup);
+        reader.read(meshInfo.vertexBuffers, meshVtxBufferCount);
+        reader.read(meshInfo.indexCount);
+        reader.read(meshInfo.indexBuffer);
+
+        auto const subMeshCount = reader.get<int32_t>();
+        file_assert(subMeshCount >= 0);
+        meshInfo.subMeshes.resize(static_cast<size_t>(subMeshCount));
+        for(auto& subMesh: meshInfo.subMeshes) {
+            reader.read(subMesh.unk0);
+            reader.read(subMesh.materialName, size_prefix<int32_t>);
+            reader.read(subMesh.firstIndex);
+            reader.read(subMesh.indexCount);
+            reader.read(subMesh.unk1);
+            reader.read(subMesh.unk2);
+        }
+
+        reader.read(meshInfo.meshUnkbool0);
+        reader.read(meshInfo.boundingBox);
+        reader.read(meshInfo.transformMatrix);
+        reader.read(meshInfo.meshUnkbool1);
+
+        if(unkbool) {
+            reader.read(meshInfo.unkvec);
+        }
+
+        reader.read(meshInfo.unkdata);
+        reader.read(meshInfo.unkstr, size_prefix<int32_t>);
+        reader.read(meshInfo.color);
+    }
+
+    // Walks a record without decoding it, stops once the record runs past the bytes loaded so far
+    struct Scanner {
+        uint8_t const* data;
+        int32_t end;
+        int32_t pos;
+        bool complete = true;
+
+        inline void skip(int64_t size) {
+            file_assert(size >= 0);
+            if(!complete || size > end - pos) {
+                complete = false;
+                return;
+            }
+            pos += static_cast<int32_t>(size);
+        }
+
+        inline int32_t get_i32() {
+            int32_t value = 0;
+            if(complete && static_cast<int32_t>(sizeof(value)) <= end - pos) {
+                memcpy(&value, data + pos, sizeof(value));
+            }
+            skip(sizeof(value));
+            return value;
+        }
+
+        inline void skip_string() {
+            auto const size = get_i32();
+            if(size > 0) {
+                skip(size);
+            }
+        }
+    };
+
+    // Size of the mesh info record starting at data, or -1 when it is not fully loaded yet
+    inline int32_t record_size(uint8_t const* data, int32_t available, bool unkbool) {
+        constexpr int32_t meshTailSize = sizeof(uint8_t) + sizeof(Box3D) + sizeof(Mtx44) + sizeof(uint8_t);
+        constexpr int32_t unkdataSize = sizeof(MapGeo::MeshInfo::unkdata);
+        auto scanner = Scanner { data, available, 0 };
+        scanner.skip_string();
+        scanner.skip(sizeof(uint32_t));
+        auto const meshVtxBufferCount = scanner.get_i32();
+        scanner.skip(sizeof(uint32_t) + static_cast<int64_t>(meshVtxBufferCount) * sizeof(uint32_t));
+        scanner.skip(sizeof(uint32_t) * 2);
+        auto const subMeshCount = scanner.get_i32();
+        file_assert(subMeshCount >= 0);
+        for(int32_t c = 0; c < subMeshCount && scanner.complete; c++) {
+            scanner.skip(sizeof(uint32_t));
+            scanner.skip_string();
+            scanner.skip(sizeof(uint32_t) * 4);
+        }
+        scanner.skip(meshTailSize + (unkbool ? static_cast<int32_t>(sizeof(Vec3)) : 0) + unkdataSize);
+        scanner.skip_string();
+        scanner.skip(sizeof(ColorF));
+        return scanner.complete ? scanner.pos : -1;
+    }
+
+    void read(MapGeo& map, File const& file, bool lazy) {
         auto const header = file.get<Header>();
         file_assert((header.magic == std::array{'O', 'E', 'G', 'M'}));
         file_assert(header.version == 6u);
@@ -17,55 +120,72 @@ namespace Rito::MapGeoImpl {
         file.read(map.vertexElemGroups, size_prefix<int32_t>);
 
         auto const vertexBufferCount = file.get<int32_t>();
+        map.vertexBuffers.reserve(static_cast<size_t>(std::max(vertexBufferCount, 0)));
         for(int32_t i = 0; i < vertexBufferCount; i++) {
-            file.read(map.vertexBuffers.emplace_back(), size_prefix<int32_t>);
+            auto const vertexBufferSize = file.get<int32_t>();
+            read_buffer(map.vertexBuffers.emplace_back(), file, vertexBufferSize, lazy);
         }
 
         auto const indexBufferCount = file.get<int32_t>();
+        map.indexBuffers.reserve(static_cast<size_t>(std::max(indexBufferCount, 0)));
         for(int32_t i = 0; i < indexBufferCount; i++) {
             auto const indexBufferSize = file.get<int32_t>();
-            file.read(map.indexBuffers.emplace_back(), indexBufferSize / 2);
+            read_buffer(map.indexBuffers.emplace_back(), file, indexBufferSize / 2, lazy);
         }
 
         auto const meshInfoCount = file.get<int32_t>();
-        for(int32_t i = 0; i < meshInfoCount; i++) {
-            auto& meshInfo = map.meshInfos.emplace_back();
-            file.read(meshInfo.name, size_prefix<int32_t>);
-            file.read(meshInfo.vertexCount);
-            auto const meshVtxBufferCount = file.get<int32_t>();
-            file.read(meshInfo.vertexElemGroup);
-            file.read(meshInfo.vertexBuffers, meshVtxBufferCount);
-            file.read(meshInfo.indexCount);
-            file.read(meshInfo.indexBuffer);
-
-            auto const subMeshCount = file.get<int32_t>();
-            for(int32_t c = 0; c < subMeshCount; c++) {
-                auto& subMesh = meshInfo.subMeshes.emplace_back();
-                file.read(subMesh.unk0);
-                file.read(subMesh.materialName, size_prefix<int32_t>);
-                file.read(subMesh.firstIndex);
-                file.read(subMesh.indexCount);
-                file.read(subMesh.unk1);
-                file.read(subMesh.unk2);
-            }
+        file_assert(meshInfoCount >= 0);
+        auto const start = file.tell();
+        file.seek_end(0);
+        auto remaining = file.tell() - start;
+        file.seek_beg(start);
+        map.meshInfos.resize(static_cast<size_t>(meshInfoCount));
 
-            file.read(meshInfo.meshUnkbool0);
-            file.read(meshInfo.boundingBox);
-            file.read(meshInfo.transformMatrix);
-            file.read(meshInfo.meshUnkbool1);
+        // Records are variable length so each window is scanned for where they begin before decoding them
+        // in parallel, only a window of the file is held at once instead of everything up to its end
+        constexpr int32_t windowSize = 1024 * 1024;
+        std::vector<uint8_t> window;
+        std::vector<int32_t> offsets;
+        auto& strings = *map.strings;
+        size_t done = 0;
+        while(done != map.meshInfos.size()) {
+            auto const fetch = std::min(windowSize, remaining);
+            file_assert(fetch > 0);
+            auto const used = window.size();
+            window.resize(used + static_cast<size_t>(fetch));
+            file.raw_read(window.data() + used, 1, fetch);
+            remaining -= fetch;
 
-            if(unkbool) {
-                file.read(meshInfo.unkvec);
+            auto const windowEnd = static_cast<int32_t>(window.size());
+            offsets.assign(1, 0);
+            while(done + offsets.size() - 1 != map.meshInfos.size()) {
+                auto const size = record_size(window.data() + offsets.back(), windowEnd - offsets.back(), unkbool);
+                if(size < 0) {
+                    break;
+                }
+                offsets.push_back(offsets.back() + size);
             }
 
-            file.read(meshInfo.unkdata);
-            file.read(meshInfo.unkstr, size_prefix<int32_t>);
-            file.read(meshInfo.color);
+            auto const records = offsets.size() - 1;
+            parallel_for(records, [&](size_t i) {
+                auto reader = Mem::Reader { window.data(), offsets[i + 1], offsets[i], &strings };
+                read_mesh_info(map.meshInfos[done + i], reader, unkbool);
+                file_assert(reader.tell() == offsets[i + 1]);
+            }, 64);
+            done += records;
+            window.erase(window.begin(), window.begin() + offsets.back());
         }
+        file.seek_beg(file.tell() - static_cast<int32_t>(window.size()));
     }
 }
 
-Rito::MapGeo::MapGeo(File const& file) {
-    Rito::MapGeoImpl::read(*this, file);
+Rito::MapGeo::MapGeo(File const& file, std::shared_ptr<StringPool> strings)
+    : strings(StringPool::shared_or_new(std::move(strings))) {
+    Rito::MapGeoImpl::read(*this, file, false);
+}
+
+Rito::MapGeo::MapGeo(File const& file, lazy_t, std::shared_ptr<StringPool> strings)
+    : strings(StringPool::shared_or_new(std::move(strings))) {
+    Rito::MapGeoImpl::read(*this, file, true);
 }
 
@@ -39,38 +39,58 @@ namespace Rito {
             struct Elem {
                 Name name = {};
                 Format format = {};
+
+                bool operator==(Elem const&) const = default;
             };
             Usage usage = {};
             uint32_t elemCount = {};
             std::array<Elem, 15> elems = {};
+
+            inline constexpr bool same_layout(VertexElemGroup const& other) const noexcept {
+                return elemCount == other.elemCount
+                        && std::equal(elems.begin(), elems.begin() + elemCount, other.elems.begin());
+            }
+
+            static inline constexpr size_t size(Format format) noexcept {
+                switch(format) {
+                case Format::X_Float32:
+                    return 4 * 1;
+                case Format::XY_Float32:
+                    return 4 * 2;
+                case Format::XYZ_Float32:
+                    return 4 * 3;
+                case Format::XYZW_Float32:
+                    return 4 * 4;
+                case Format::BGRA_Packed8888:
+                case Format::RGBA_Packed8888:
+                    return 4;
+                }
+                return 0;
+            }
+
             inline constexpr size_t size() const noexcept {
                 size_t s = 0;
                 for(uint32_t i = 0; i < elemCount; i++) {
-                    switch(elems[i].format) {
-                    case Format::X_Float32:
-                        s += 4 * 1;
-                    break;
-                    case Format::XY_Float32:
-                        s += 4 * 2;
-                    break;
-                    case Format::XYZ_Float32:
-                        s += 4 * 3;
-                    break;
-                    case Format::XYZW_Float32:
-                        s += 4 * 4;
-                    break;
-                    case Format::BGRA_Packed8888:
-                    case Format::RGBA_Packed8888:
-                        s += 4;
-                        break;
-                    }
+                    s += size(elems[i].format);
                 }
                 return s;
             }
+
+            // Byte offset of element inside vertex or -1 if missing
+            inline constexpr int32_t offset_of(Name name, Format format) const noexcept {
+                size_t s = 0;
+                for(uint32_t i = 0; i < elemCount; i++) {
+                    if(elems[i].name == name) {
+                        return elems[i].format == format ? static_cast<int32_t>(s) : -1;
+                    }
+                    s += size(elems[i].format);
+                }
+                return -1;
+            }
         };
         struct SubMesh {
             uint32_t unk0;
-            std::string materialName;
+            InternedString materialName;
             uint32_t firstIndex;
             uint32_t indexCount;
             uint32_t unk1;
@@ -78,7 +98,7 @@ namespace Rito {
         };
 
         struct MeshInfo {
-            std::string name;
+            InternedString name;
             uint32_t vertexElemGroup;
             uint32_t vertexCount;
             std::vector<uint32_t> vertexBuffers;
@@ -91,16 +111,22 @@ namespace Rito {
             uint8_t meshUnkbool1 = 0;
             Vec3 unkvec = {};
             std::array<uint8_t, 108> unkdata = {};
-            std::string unkstr;
+            InternedString unkstr;
 
             ColorF color;
         };
 
         std::vector<VertexElemGroup> vertexElemGroups = {};
-        std::vector<std::vector<uint8_t>> vertexBuffers = {};
-        std::vector<std::vector<uint16_t>> indexBuffers = {};
+        std::vector<LazyArr<uint8_t>> vertexBuffers = {};
+        std::vector<LazyArr<uint16_t>> indexBuffers = {};
         std::vector<MeshInfo> meshInfos = {};
-        MapGeo(File const& file);
+        // Pool of the mesh and material names
+        std::shared_ptr<StringPool> strings = {};
+
+        // Names go into strings, a new pool when it is null
+        MapGeo(File const& file, std::shared_ptr<StringPool> strings = {});
+        // Only records buffer locations, use LazyArr::get to load them on first access
+        MapGeo(File const& file, lazy_t, std::shared_ptr<StringPool> strings = {});
     };
 }
 
@@ -0,0 +1,199 @@
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include "mapgeobatch.hpp"
+
+using namespace Rito;
+
+namespace Rito::MapGeoBatchImpl {
+    using Name = MapGeo::VertexElemGroup::Name;
+    using Format = MapGeo::VertexElemGroup::Format;
+
+    struct Pending {
+        MapGeoBatch::Batch batch;
+        std::vector<uint32_t> indices;
+    };
+
+    inline bool is_identity(Mtx44 const& m) noexcept {
+        auto const identity = Mtx44::identity();
+        return std::memcmp(&m, &identity, sizeof(Mtx44)) == 0;
+    }
+
+    // MapGeo matrices are stored for row vectors: p' = p * M
+    inline Vec3 transform_point(Mtx44 const& m, Vec3 const& p) noexcept {
+        return {
+            p.x * m[0][0] + p.y * m[1][0] + p.z * m[2][0] + m[3][0],
+            p.x * m[0][1] + p.y * m[1][1] + p.z * m[2][1] + m[3][1],
+            p.x * m[0][2] + p.y * m[1][2] + p.z * m[2][2] + m[3][2],
+        };
+    }
+
+    // Normals go through the inverse transpose of the matrix, inv is the plain inverse
+    inline Vec3 transform_normal(Mtx44 const& inv, Vec3 const& n) noexcept {
+        auto const r = Vec3 {
+            n.x * inv[0][0] + n.y * inv[0][1] + n.z * inv[0][2],
+            n.x * inv[1][0] + n.y * inv[1][1] + n.z * inv[1][2],
+            n.x * inv[2][0] + n.y * inv[2][1] + n.z * inv[2][2],
+        };
+        auto const l = r.length();
+        return l > 0.0f ? Vec3 { r.x / l, r.y / l, r.z / l } : r;
+    }
+
+    // Negative when the upper 3x3 mirrors, baking such a transform turns triangles inside out
+    inline float determinant3(Mtx44 const& m) noexcept {
+        return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+             - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+             + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+    }
+
+    inline void grow(Box3D& box, Vec3 const& p) noexcept {
+        box.min = { std::min(box.min.x, p.x), std::min(box.min.y, p.y), std::min(box.min.z, p.z) };
+        box.max = { std::max(box.max.x, p.x), std::max(box.max.y, p.y), std::max(box.max.z, p.z) };
+    }
+
+    // Source streams of one mesh, shared by every batch its submeshes land in
+    struct MeshVertices {
+        std::vector<uint8_t const*> streams;
+        std::vector<size_t> strides;
+        std::vector<int32_t> positions;
+        std::vector<int32_t> normals;
+        Mtx44 transform;
+        Mtx44 inv;
+        bool identity;
+        bool mirrored;
+
+        MeshVertices(MapGeo& map, File const& file, MapGeo::MeshInfo const& meshInfo)
+            : transform(meshInfo.transformMatrix),
+              inv(Mtx44::identity()),
+              identity(is_identity(meshInfo.transformMatrix)),
+              mirrored(!identity && determinant3(meshInfo.transformMatrix) < 0.0f) {
+            if(!identity) {
+                inv = transform.inv();
+            }
+            auto const groups = map.vertexElemGroups.begin() + meshInfo.vertexElemGroup;
+            for(size_t s = 0; s != meshInfo.vertexBuffers.size(); s++) {
+                file_assert(meshInfo.vertexBuffers[s] < map.vertexBuffers.size());
+                auto const& group = groups[static_cast<ptrdiff_t>(s)];
+                auto const& source = map.vertexBuffers[meshInfo.vertexBuffers[s]].get(file);
+                file_assert(group.size() * meshInfo.vertexCount <= source.size());
+                streams.push_back(source.data());
+                strides.push_back(group.size());
+                positions.push_back(group.offset_of(Name::Position, Format::XYZ_Float32));
+                normals.push_back(group.offset_of(Name::Normal, Format::XYZ_Float32));
+            }
+        }
+    };
+
+    // Mesh vertex index to batch vertex index, only vertices referenced by the batch are copied
+    struct MeshRemap {
+        size_t batchIndex;
+        std::vector<uint32_t> remap;
+    };
+
+    constexpr uint32_t unmapped = std::numeric_limits<uint32_t>::max();
+
+    // Appends one mesh vertex to batch, transforming position and normal in place
+    inline uint32_t append_vertex(Pending& pending, MeshVertices const& mesh, uint32_t vertex) {
+        auto& batch = pending.batch;
+        for(size_t s = 0; s != mesh.streams.size(); s++) {
+            auto const stride = mesh.strides[s];
+            auto const source = mesh.streams[s] + stride * vertex;
+            auto& target = batch.vertexBuffers[s];
+            auto const start = target.size();
+            target.insert(target.end(), source, source + stride);
+            auto const i = target.data() + start;
+
+            if(auto const position = mesh.positions[s]; position != -1) {
+                Vec3 p;
+                memcpy(&p, i + position, sizeof(Vec3));
+                if(!mesh.identity) {
+                    p = transform_point(mesh.transform, p);
+                    memcpy(i + position, &p, sizeof(Vec3));
+                }
+                grow(batch.boundingBox, p);
+            }
+            if(auto const normal = mesh.normals[s]; normal != -1 && !mesh.identity) {
+                Vec3 n;
+                memcpy(&n, i + normal, sizeof(Vec3));
+                n = transform_normal(mesh.inv, n);
+                memcpy(i + normal, &n, sizeof(Vec3));
+            }
+        }
+        return batch.vertexCount++;
+    }
+}
+
+MapGeoBatch::MapGeoBatch(MapGeo& map, File const& file) : strings(map.strings) {
+    using namespace Rito::MapGeoBatchImpl;
+    constexpr auto inf = std::numeric_limits<float>::infinity();
+    std::vector<Pending> pendings;
+    std::unordered_map<InternedString, std::vector<size_t>> byMaterial;
+    std::vector<MeshRemap> meshRemaps;
+
+    for(auto const& meshInfo: map.meshInfos) {
+        auto const streamCount = meshInfo.vertexBuffers.size();
+        file_assert(meshInfo.vertexElemGroup + streamCount <= map.vertexElemGroups.size());
+        auto const groups = map.vertexElemGroups.begin() + meshInfo.vertexElemGroup;
+        file_assert(meshInfo.indexBuffer < map.indexBuffers.size());
+        auto const& indices = map.indexBuffers[meshInfo.indexBuffer].get(file);
+
+        if(meshInfo.subMeshes.empty()) {
+            continue;
+        }
+        auto const mesh = MeshVertices(map, file, meshInfo);
+        meshRemaps.clear();
+        for(auto const& subMesh: meshInfo.subMeshes) {
+            auto& candidates = byMaterial[subMesh.materialName];
+            auto const found = std::find_if(candidates.begin(), candidates.end(), [&](size_t b) {
+                auto const& batchGroups = pendings[b].batch.vertexElemGroups;
+                return batchGroups.size() == streamCount
+                        && std::equal(batchGroups.begin(), batchGroups.end(), groups,
+                                      [](auto const& l, auto const& r) { return l.same_layout(r); });
+            });
+            size_t batchIndex = 0;
+            if(found != candidates.end()) {
+                batchIndex = *found;
+            } else {
+                batchIndex = pendings.size();
+                candidates.push_back(batchIndex);
+                auto& batch = pendings.emplace_back().batch;
+                batch.materialName = subMesh.materialName;
+                batch.vertexElemGroups.assign(groups, groups + static_cast<ptrdiff_t>(streamCount));
+                batch.vertexBuffers.resize(streamCount);
+                batch.boundingBox = { { inf, inf, inf }, { -inf, -inf, -inf } };
+            }
+
+            auto remap = std::find_if(meshRemaps.begin(), meshRemaps.end(), [batchIndex](auto const& r) {
+                return r.batchIndex == batchIndex;
+            });
+            if(remap == meshRemaps.end()) {
+                remap = meshRemaps.insert(meshRemaps.end(), { batchIndex, std::vector<uint32_t>(meshInfo.vertexCount, unmapped) });
+            }
+
+            file_assert(subMesh.firstIndex + subMesh.indexCount <= indices.size());
+            auto& pending = pendings[batchIndex];
+            auto const first = pending.indices.size();
+            for(auto i = subMesh.firstIndex; i != subMesh.firstIndex + subMesh.indexCount; i++) {
+                auto const vertex = indices[i];
+                file_assert(vertex < meshInfo.vertexCount);
+                auto& mapped = remap->remap[vertex];
+                if(mapped == unmapped) {
+                    mapped = append_vertex(pending, mesh, vertex);
+                }
+                pending.indices.push_back(mapped);
+            }
+            if(mesh.mirrored) {
+                for(auto t = first; t + 3 <= pending.indices.size(); t += 3) {
+                    std::swap(pending.indices[t + 1], pending.indices[t + 2]);
+                }
+            }
+        }
+    }
+
+    batches.reserve(pendings.size());
+    for(auto& pending: pendings) {
+        auto& batch = batches.emplace_back(std::move(pending.batch));
+        batch.indices = IndexBuffer::narrowest(std::move(pending.indices));
+    }
+}
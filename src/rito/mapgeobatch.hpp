@@ -0,0 +1,31 @@
+#ifndef RITO_MAPGEOBATCH_HPP
+#define RITO_MAPGEOBATCH_HPP
+#include <cinttypes>
+#include <vector>
+#include "file.hpp"
+#include "types.hpp"
+#include "mapgeo.hpp"
+
+namespace Rito {
+    // MapGeo submeshes merged by material and vertex layout with transforms baked in
+    struct MapGeoBatch {
+        struct Batch {
+            InternedString materialName;
+            // One group and one buffer per vertex stream
+            std::vector<MapGeo::VertexElemGroup> vertexElemGroups;
+            std::vector<std::vector<uint8_t>> vertexBuffers;
+            uint32_t vertexCount = {};
+            // 32-bit only when vertexCount does not fit 16 bits
+            IndexBuffer indices;
+            Box3D boundingBox;
+        };
+        std::vector<Batch> batches;
+        // Pool of the material names, shared with the map
+        std::shared_ptr<StringPool> strings;
+
+        // Buffers of lazy loaded maps are materialized from file as they are needed
+        MapGeoBatch(MapGeo& map, File const& file);
+    };
+}
+
+#endif // RITO_MAPGEOBATCH_HPP
@@ -3,6 +3,9 @@
 #include <cinttypes>
 #include <cstddef>
 #include <vector>
+#include <cstring>
+#include <string>
+#include <span>
 #include "file.hpp"
 
 namespace Rito::Mem {
@@ -16,6 +19,8 @@ namespace Rito::Mem {
     struct RelPtrArr;
     template<typename T>
     struct FlexArr;
+    template<typename T>
+    struct PtrSpan;
 
     // Absolute pointer from begining of resource
     template<typename T>
@@ -28,6 +33,14 @@ namespace Rito::Mem {
             }
             return reinterpret_cast<T const*>(reinterpret_cast<intptr_t>(&obj) + offset) + idx;
         }
+
+        template<typename B>
+        inline std::span<T const> span(B const& obj, size_t count) const noexcept {
+            if(auto const ptr = get(obj); ptr) {
+                return { ptr, count };
+            }
+            return {};
+        }
     };
 
     // Absolute pointer to array containt absolute pointers from beging or resources
@@ -46,6 +59,15 @@ namespace Rito::Mem {
             }
             return reinterpret_cast<T const*>(base + ptr);
         }
+
+        template<typename B>
+        inline PtrSpan<T> span(B const& obj, size_t count) const noexcept {
+            if(offset == 0 || offset == -1) {
+                return {};
+            }
+            auto const base = reinterpret_cast<uint8_t const*>(&obj);
+            return { base, reinterpret_cast<int32_t const*>(base + offset), count };
+        }
     };
 
     // Relative pointer from this containing linear elements
@@ -59,6 +81,13 @@ namespace Rito::Mem {
             auto const base = reinterpret_cast<intptr_t>(&offset) + offset;
             return reinterpret_cast<T const*>(base) + idx;
         }
+
+        inline std::span<T const> span(size_t count) const noexcept {
+            if(auto const ptr = get(); ptr) {
+                return { ptr, count };
+            }
+            return {};
+        }
     };
 
     // Relative pointer from this containing relative pointers from begining of array
@@ -76,6 +105,14 @@ namespace Rito::Mem {
             }
             return reinterpret_cast<T const*>(base + ptr);
         }
+
+        inline PtrSpan<T> span(size_t count) const noexcept {
+            if(offset == 0 || offset == -1) {
+                return {};
+            }
+            auto const base = reinterpret_cast<uint8_t const*>(&offset) + offset;
+            return { base, reinterpret_cast<int32_t const*>(base), count };
+        }
     };
 
     template<typename T>
@@ -83,6 +120,174 @@ namespace Rito::Mem {
         inline T const* get(size_t idx = 0) const noexcept {
             return reinterpret_cast<T const*>(this) + idx;
         }
+
+        inline std::span<T const> span(size_t count) const noexcept {
+            return { get(), count };
+        }
+    };
+
+    // Array of offsets from base, each pointing to one element, as addressed by AbsPtrArr and RelPtrArr.
+    // Offsets are not checked, only use over validated memory.
+    template<typename T>
+    struct PtrSpan {
+        uint8_t const* base = {};
+        int32_t const* offsets = {};
+        size_t count = {};
+
+        struct iterator {
+            PtrSpan const* span;
+            size_t idx;
+
+            inline T const& operator*() const noexcept {
+                return (*span)[idx];
+            }
+
+            inline iterator& operator++() noexcept {
+                ++idx;
+                return *this;
+            }
+
+            inline bool operator==(iterator const& other) const noexcept {
+                return idx == other.idx;
+            }
+        };
+
+        inline T const& operator[](size_t idx) const noexcept {
+            return *reinterpret_cast<T const*>(base + offsets[idx]);
+        }
+
+        inline size_t size() const noexcept {
+            return count;
+        }
+
+        inline bool empty() const noexcept {
+            return count == 0;
+        }
+
+        inline iterator begin() const noexcept {
+            return { this, 0 };
+        }
+
+        inline iterator end() const noexcept {
+            return { this, count };
+        }
+    };
+
+    // Non owning view over every stride bytes of memory, used to address interleaved vertex data in place
+    template<typename T>
+    struct Strided {
+        uint8_t const* data = {};
+        size_t stride = sizeof(T);
+        size_t count = {};
+
+        struct iterator {
+            uint8_t const* ptr;
+            size_t stride;
+
+            inline T const& operator*() const noexcept {
+                return *reinterpret_cast<T const*>(ptr);
+            }
+
+            inline iterator& operator++() noexcept {
+                ptr += stride;
+                return *this;
+            }
+
+            inline bool operator==(iterator const& other) const noexcept {
+                return ptr == other.ptr;
+            }
+        };
+
+        inline T const& operator[](size_t idx) const noexcept {
+            return *reinterpret_cast<T const*>(data + idx * stride);
+        }
+
+        inline size_t size() const noexcept {
+            return count;
+        }
+
+        inline bool empty() const noexcept {
+            return count == 0;
+        }
+
+        inline iterator begin() const noexcept {
+            return { data, stride };
+        }
+
+        inline iterator end() const noexcept {
+            return { data + count * stride, stride };
+        }
+    };
+
+    // Bounds checked cursor over a memory buffer with the same read api as File
+    struct Reader {
+        uint8_t const* data = {};
+        int32_t end = {};
+        int32_t pos = {};
+        // Pool names are interned into, needed only to read InternedString
+        StringPool* strings = {};
+
+        inline int32_t tell() const noexcept {
+            return pos;
+        }
+
+        inline void seek_beg(int32_t offset) {
+            file_assert(offset >= 0 && offset <= end);
+            pos = offset;
+        }
+
+        inline void seek_cur(int32_t offset) {
+            file_assert(offset <= end - pos && offset >= -pos);
+            pos += offset;
+        }
+
+        inline void raw_read(void* dst, int32_t size, int32_t count) {
+            file_assert(size >= 0 && count >= 0);
+            auto const total = static_cast<int64_t>(size) * count;
+            file_assert(total <= end - pos);
+            memcpy(dst, data + pos, static_cast<size_t>(total));
+            pos += static_cast<int32_t>(total);
+        }
+
+        template<typename T, typename...ARGS>
+        inline T get(ARGS&&...args) {
+            T value{};
+            read(value, std::forward<ARGS>(args)...);
+            return value;
+        }
+
+        template<typename T>
+        inline void read(T& value) {
+            raw_read(&value, sizeof(T), 1);
+        }
+
+        template<typename T>
+        inline void read(std::vector<T>& value, int32_t count) {
+            file_assert(count >= 0 && static_cast<int64_t>(count) * static_cast<int64_t>(sizeof(T)) <= end - pos);
+            value.resize(static_cast<size_t>(count));
+            raw_read(value.data(), sizeof(T), count);
+        }
+
+        inline void read(std::string& value, int32_t count) {
+            file_assert(count >= 0 && count <= end - pos);
+            value.assign(reinterpret_cast<char const*>(data + pos), static_cast<size_t>(count));
+            pos += count;
+        }
+
+        template<typename T, typename P>
+        inline void read(T& value, size_prefix_t<P>) {
+            auto const size = get<P>();
+            if(size > 0) {
+                read(value, static_cast<int32_t>(size));
+            }
+        }
+
+        inline void read(InternedString& value, int32_t count) {
+            file_assert(count >= 0 && count <= end - pos);
+            file_assert(strings);
+            value = strings->intern({ reinterpret_cast<char const*>(data + pos), static_cast<size_t>(count) });
+            pos += count;
+        }
     };
 }
 
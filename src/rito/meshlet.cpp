@@ -0,0 +1,243 @@
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include "meshlet.hpp"
+#include "parallel.hpp"
+
+using namespace Rito;
+
+namespace Rito::MeshletImpl {
+    constexpr auto unused = std::numeric_limits<uint8_t>::max();
+
+    inline int8_t snorm8(float value) noexcept {
+        auto const scaled = std::round(std::clamp(value, -1.0f, 1.0f) * 127.0f);
+        return static_cast<int8_t>(scaled);
+    }
+
+    inline Vec3 sub(Vec3 const& a, Vec3 const& b) noexcept {
+        return { a.x - b.x, a.y - b.y, a.z - b.z };
+    }
+
+    inline Vec3 cross(Vec3 const& a, Vec3 const& b) noexcept {
+        return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+    }
+
+    inline float dot(Vec3 const& a, Vec3 const& b) noexcept {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    // Quantized cone axis as a unit vector, the cutoff is measured against exactly this axis
+    inline Vec3 cone_axis(std::array<int8_t, 4> const& cone) noexcept {
+        auto const axis = Vec3 { cone[0] / 127.0f, cone[1] / 127.0f, cone[2] / 127.0f };
+        auto const l = axis.length();
+        return l > 0.0f ? Vec3 { axis.x / l, axis.y / l, axis.z / l } : axis;
+    }
+
+    inline void finish(Meshlets& result, Meshlets::Meshlet& meshlet, Vec3 const* positions) {
+        auto const* vertices = result.vertices.data() + meshlet.vertexOffset;
+        auto const* triangles = result.triangles.data() + meshlet.triangleOffset;
+
+        auto constexpr inf = std::numeric_limits<float>::infinity();
+        auto lo = Vec3 { inf, inf, inf };
+        auto hi = Vec3 { -inf, -inf, -inf };
+        for(size_t v = 0; v != meshlet.vertexCount; v++) {
+            auto const& p = positions[vertices[v]];
+            lo = { std::min(lo.x, p.x), std::min(lo.y, p.y), std::min(lo.z, p.z) };
+            hi = { std::max(hi.x, p.x), std::max(hi.y, p.y), std::max(hi.z, p.z) };
+        }
+        auto const center = Vec3 { (lo.x + hi.x) * 0.5f, (lo.y + hi.y) * 0.5f, (lo.z + hi.z) * 0.5f };
+        auto radius = 0.0f;
+        for(size_t v = 0; v != meshlet.vertexCount; v++) {
+            radius = std::max(radius, sub(positions[vertices[v]], center).length());
+        }
+        meshlet.bounds = { center, radius };
+
+        auto axis = Vec3 {};
+        std::array<Vec3, meshletMaxTriangles> normals;
+        size_t normalCount = 0;
+        for(size_t t = 0; t != meshlet.triangleCount; t++) {
+            auto const& a = positions[vertices[triangles[t * 3 + 0]]];
+            auto const& b = positions[vertices[triangles[t * 3 + 1]]];
+            auto const& c = positions[vertices[triangles[t * 3 + 2]]];
+            auto const n = cross(sub(b, a), sub(c, a));
+            auto const l = n.length();
+            if(l <= 0.0f) {
+                continue;
+            }
+            auto const unit = Vec3 { n.x / l, n.y / l, n.z / l };
+            axis = { axis.x + unit.x, axis.y + unit.y, axis.z + unit.z };
+            if(normalCount != normals.size()) {
+                normals[normalCount++] = unit;
+            }
+        }
+        auto const axisLength = axis.length();
+        auto minDot = 1.0f;
+        if(axisLength > 0.0f) {
+            axis = { axis.x / axisLength, axis.y / axisLength, axis.z / axisLength };
+            meshlet.cone = { snorm8(axis.x), snorm8(axis.y), snorm8(axis.z), 0 };
+            // Spread of the normals around the axis that is actually stored, so rounding the axis widens the cone
+            // instead of tilting it away from some normals
+            auto const stored = cone_axis(meshlet.cone);
+            for(size_t n = 0; n != normalCount; n++) {
+                minDot = std::min(minDot, dot(normals[n], stored));
+            }
+        }
+        if(axisLength <= 0.0f || minDot <= 0.0f) {
+            // Cone wider than a hemisphere can never be culled
+            meshlet.cone = { 0, 0, 0, 127 };
+            return;
+        }
+        auto const cutoff = std::sqrt(1.0f - minDot * minDot);
+        // Round cutoff up so quantization never culls visible triangles
+        meshlet.cone[3] = static_cast<int8_t>(std::min(127.0f, std::ceil(cutoff * 127.0f) + 1.0f));
+    }
+
+    // Meshlet local indices are 8 bit with the top value marking unassigned vertices
+    inline size_t clamp_vertices(size_t maxVertices) noexcept {
+        return std::clamp<size_t>(maxVertices, 3, unused);
+    }
+}
+
+bool Meshlets::Meshlet::backfacing(Vec3 const& eye) const noexcept {
+    using namespace Rito::MeshletImpl;
+    auto const axis = cone_axis(cone);
+    auto const cutoff = cone[3] / 127.0f;
+    auto const toCenter = sub(bounds.centerPoint, eye);
+    return dot(toCenter, axis) >= cutoff * toCenter.length() + bounds.radius;
+}
+
+Meshlets Rito::BuildMeshlets(uint32_t const* indices, size_t indexCount,
+                             Vec3 const* positions, size_t vertexCount,
+                             size_t maxVertices, size_t maxTriangles) {
+    using namespace Rito::MeshletImpl;
+    maxVertices = clamp_vertices(maxVertices);
+    maxTriangles = std::clamp<size_t>(maxTriangles, 1, meshletMaxTriangles);
+
+    Meshlets result;
+    auto const triCount = indexCount / 3;
+    result.meshlets.reserve(triCount / maxTriangles + 1);
+    result.vertices.reserve(triCount);
+    result.triangles.reserve(triCount * 4);
+
+    std::vector<uint8_t> local(vertexCount, unused);
+    auto current = Meshlets::Meshlet {};
+    auto const flush = [&] {
+        if(current.triangleCount == 0) {
+            return;
+        }
+        finish(result, current, positions);
+        result.meshlets.push_back(current);
+        for(size_t v = 0; v != current.vertexCount; v++) {
+            local[result.vertices[current.vertexOffset + v]] = unused;
+        }
+        result.triangles.resize((result.triangles.size() + 3) & ~size_t{3});
+        current = {};
+        current.vertexOffset = static_cast<uint32_t>(result.vertices.size());
+        current.triangleOffset = static_cast<uint32_t>(result.triangles.size());
+    };
+
+    for(size_t t = 0; t != triCount; t++) {
+        auto const tri = indices + t * 3;
+        file_assert(tri[0] < vertexCount && tri[1] < vertexCount && tri[2] < vertexCount);
+        auto const fresh = (local[tri[0]] == unused ? 1u : 0u)
+                + (local[tri[1]] == unused && tri[1] != tri[0] ? 1u : 0u)
+                + (local[tri[2]] == unused && tri[2] != tri[0] && tri[2] != tri[1] ? 1u : 0u);
+        if(current.vertexCount + fresh > maxVertices || current.triangleCount + 1u > maxTriangles) {
+            flush();
+        }
+        for(size_t c = 0; c != 3; c++) {
+            auto& slot = local[tri[c]];
+            if(slot == unused) {
+                slot = current.vertexCount++;
+                result.vertices.push_back(tri[c]);
+            }
+            result.triangles.push_back(slot);
+        }
+        current.triangleCount++;
+    }
+    flush();
+    return result;
+}
+
+std::vector<Meshlets> Rito::BuildMeshlets(SimpleSkin const& skn, size_t maxVertices, size_t maxTriangles) {
+    auto submeshes = skn.submeshes;
+    if(submeshes.empty()) {
+        submeshes.push_back({
+                                {},
+                                0,
+                                static_cast<int32_t>(skn.vtxPositions.size()),
+                                0,
+                                static_cast<int32_t>(skn.indices.size())
+                            });
+    }
+    std::vector<Meshlets> result(submeshes.size());
+    parallel_for(submeshes.size(), [&](size_t s) {
+        auto const& submesh = submeshes[s];
+        auto const firstVertex = static_cast<size_t>(submesh.firstVertex);
+        auto const firstIndex = static_cast<size_t>(submesh.firstIndex);
+        auto const indexCount = static_cast<size_t>(submesh.indexCount);
+        file_assert(firstVertex + static_cast<size_t>(submesh.vertexCount) <= skn.vtxPositions.size());
+        file_assert(firstIndex + indexCount <= skn.indices.size());
+        std::vector<uint32_t> indices(indexCount);
+        for(size_t i = 0; i != indexCount; i++) {
+            auto const index = skn.indices[firstIndex + i];
+            file_assert(index >= firstVertex);
+            indices[i] = index - static_cast<uint32_t>(firstVertex);
+        }
+        auto& meshlets = result[s];
+        meshlets = BuildMeshlets(indices.data(), indices.size(),
+                                 skn.vtxPositions.data() + firstVertex,
+                                 static_cast<size_t>(submesh.vertexCount),
+                                 maxVertices, maxTriangles);
+        for(auto& vertex: meshlets.vertices) {
+            vertex += static_cast<uint32_t>(firstVertex);
+        }
+    });
+    return result;
+}
+
+std::vector<Meshlets> Rito::BuildMeshlets(MapGeo& map, File const& file, size_t maxVertices, size_t maxTriangles) {
+    using Name = MapGeo::VertexElemGroup::Name;
+    using Format = MapGeo::VertexElemGroup::Format;
+    // Position stream of every mesh, loaded up front as lazy buffers can not be shared between threads
+    std::vector<std::pair<uint32_t, int32_t>> streams(map.meshInfos.size(), { 0, -1 });
+    for(size_t m = 0; m != map.meshInfos.size(); m++) {
+        auto const& meshInfo = map.meshInfos[m];
+        for(size_t s = 0; s != meshInfo.vertexBuffers.size(); s++) {
+            file_assert(meshInfo.vertexElemGroup + s < map.vertexElemGroups.size());
+            auto const& group = map.vertexElemGroups[meshInfo.vertexElemGroup + s];
+            auto const offset = group.offset_of(Name::Position, Format::XYZ_Float32);
+            if(offset != -1) {
+                file_assert(meshInfo.vertexBuffers[s] < map.vertexBuffers.size());
+                streams[m] = { static_cast<uint32_t>(s), offset };
+                map.vertexBuffers[meshInfo.vertexBuffers[s]].get(file);
+                break;
+            }
+        }
+        file_assert(meshInfo.indexBuffer < map.indexBuffers.size());
+        map.indexBuffers[meshInfo.indexBuffer].get(file);
+    }
+
+    std::vector<Meshlets> result(map.meshInfos.size());
+    parallel_for(map.meshInfos.size(), [&](size_t m) {
+        auto const& meshInfo = map.meshInfos[m];
+        auto const [stream, offset] = streams[m];
+        if(offset == -1) {
+            return;
+        }
+        auto const& group = map.vertexElemGroups[meshInfo.vertexElemGroup + stream];
+        auto const& vertices = map.vertexBuffers[meshInfo.vertexBuffers[stream]].items;
+        auto const stride = group.size();
+        file_assert(stride * meshInfo.vertexCount <= vertices.size());
+        std::vector<Vec3> positions(meshInfo.vertexCount);
+        for(size_t v = 0; v != positions.size(); v++) {
+            memcpy(&positions[v], vertices.data() + v * stride + static_cast<size_t>(offset), sizeof(Vec3));
+        }
+        auto const& source = map.indexBuffers[meshInfo.indexBuffer].items;
+        file_assert(meshInfo.indexCount <= source.size());
+        std::vector<uint32_t> indices(source.begin(), source.begin() + meshInfo.indexCount);
+        result[m] = BuildMeshlets(indices.data(), indices.size(), positions.data(), positions.size(),
+                                  maxVertices, maxTriangles);
+    }, 16);
+    return result;
+}
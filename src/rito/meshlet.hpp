@@ -0,0 +1,55 @@
+#ifndef RITO_MESHLET_HPP
+#define RITO_MESHLET_HPP
+#include <cinttypes>
+#include <vector>
+#include "types.hpp"
+#include "file.hpp"
+#include "simpleskin.hpp"
+#include "mapgeo.hpp"
+
+namespace Rito {
+    struct Meshlets {
+        struct Meshlet {
+            uint32_t vertexOffset;
+            // Byte offset into triangles, always 4 byte aligned
+            uint32_t triangleOffset;
+            uint8_t vertexCount;
+            uint8_t triangleCount;
+            uint16_t pad;
+            // Normal cone axis xyz and cutoff as snorm8, meshlet is backfacing when
+            // dot(bounds.centerPoint - eye, axis) >= cutoff * length(bounds.centerPoint - eye) + bounds.radius
+            // The radius term keeps the test conservative for every point of bounds.
+            // axis is the dequantized xyz normalized, the cutoff was measured against it
+            std::array<int8_t, 4> cone;
+            Sphere bounds;
+
+            // Cone test above on the dequantized cone
+            bool backfacing(Vec3 const& eye) const noexcept;
+        };
+        std::vector<Meshlet> meshlets;
+        // Mesh vertex index for every meshlet vertex
+        std::vector<uint32_t> vertices;
+        // 3 meshlet local vertex indices per triangle
+        std::vector<uint8_t> triangles;
+    };
+
+    constexpr size_t meshletMaxVertices = 64;
+    constexpr size_t meshletMaxTriangles = 124;
+
+    extern Meshlets BuildMeshlets(uint32_t const* indices, size_t indexCount,
+                                  Vec3 const* positions, size_t vertexCount,
+                                  size_t maxVertices = meshletMaxVertices,
+                                  size_t maxTriangles = meshletMaxTriangles);
+
+    // One result per submesh (or for whole skin without submeshes), built in parallel
+    extern std::vector<Meshlets> BuildMeshlets(SimpleSkin const& skn,
+                                               size_t maxVertices = meshletMaxVertices,
+                                               size_t maxTriangles = meshletMaxTriangles);
+
+    // One result per MapGeo::meshInfos entry in mesh local vertex space, built in parallel
+    extern std::vector<Meshlets> BuildMeshlets(MapGeo& map, File const& file,
+                                               size_t maxVertices = meshletMaxVertices,
+                                               size_t maxTriangles = meshletMaxTriangles);
+}
+
+#endif // RITO_MESHLET_HPP
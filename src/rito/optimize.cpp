@@ -0,0 +1,333 @@
+#include <cmath>
+#include <algorithm>
+#include "optimize.hpp"
+
+using namespace Rito;
+
+namespace Rito::OptimizeImpl {
+    // Forsyth, "Linear-Speed Vertex Cache Optimisation"
+    constexpr size_t cacheSize = 32;
+    constexpr float cacheDecayPower = 1.5f;
+    constexpr float lastTriScore = 0.75f;
+    constexpr float valenceBoostScale = 2.0f;
+    constexpr float valenceBoostPower = 0.5f;
+    // Post transform cache size used to measure cache efficiency
+    constexpr size_t fifoSize = 16;
+
+    inline float vertex_score(int32_t cachePosition, uint32_t remaining) noexcept {
+        if(remaining == 0) {
+            return -1.0f;
+        }
+        auto score = 0.0f;
+        if(cachePosition >= 0) {
+            if(cachePosition < 3) {
+                score = lastTriScore;
+            } else {
+                auto const scale = 1.0f / static_cast<float>(cacheSize - 3);
+                score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scale, cacheDecayPower);
+            }
+        }
+        return score + valenceBoostScale * std::pow(static_cast<float>(remaining), -valenceBoostPower);
+    }
+
+    struct Fifo {
+        std::vector<uint32_t> stamps;
+        uint32_t time = fifoSize + 1;
+
+        explicit Fifo(size_t vertexCount) : stamps(vertexCount, 0) {}
+
+        // Returns true on cache miss
+        inline bool touch(uint32_t v) noexcept {
+            if(time - stamps[v] > fifoSize) {
+                stamps[v] = time++;
+                return true;
+            }
+            return false;
+        }
+    };
+}
+
+void Rito::OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount) {
+    using namespace Rito::OptimizeImpl;
+    auto const triCount = indexCount / 3;
+    if(triCount == 0) {
+        return;
+    }
+
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for(size_t i = 0; i != triCount * 3; i++) {
+        file_assert(indices[i] < vertexCount);
+        remaining[indices[i]]++;
+    }
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for(size_t v = 0; v != vertexCount; v++) {
+        offsets[v + 1] = offsets[v] + remaining[v];
+    }
+    std::vector<uint32_t> adjacency(triCount * 3);
+    {
+        auto fill = offsets;
+        for(size_t t = 0; t != triCount; t++) {
+            for(size_t c = 0; c != 3; c++) {
+                adjacency[fill[indices[t * 3 + c]]++] = static_cast<uint32_t>(t);
+            }
+        }
+    }
+
+    std::vector<float> vertexScores(vertexCount);
+    for(size_t v = 0; v != vertexCount; v++) {
+        vertexScores[v] = vertex_score(-1, remaining[v]);
+    }
+    std::vector<float> triScores(triCount);
+    std::vector<bool> emitted(triCount, false);
+    for(size_t t = 0; t != triCount; t++) {
+        triScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+    }
+
+    std::vector<uint32_t> result;
+    result.reserve(triCount * 3);
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> nextCache;
+    cache.reserve(cacheSize + 3);
+    nextCache.reserve(cacheSize + 3);
+    size_t cursor = 0;
+    auto best = static_cast<size_t>(std::max_element(triScores.begin(), triScores.end()) - triScores.begin());
+    while(result.size() != triCount * 3) {
+        if(best == triCount) {
+            while(emitted[cursor]) {
+                cursor++;
+            }
+            best = cursor;
+        }
+        emitted[best] = true;
+        auto const* tri = indices + best * 3;
+        nextCache.clear();
+        for(size_t c = 0; c != 3; c++) {
+            auto const v = tri[c];
+            result.push_back(v);
+            nextCache.push_back(v);
+            remaining[v]--;
+            auto const begin = adjacency.begin() + offsets[v];
+            auto const end = begin + remaining[v] + 1;
+            // Move emitted triangle out of the live part of adjacency list
+            std::iter_swap(std::find(begin, end, static_cast<uint32_t>(best)), end - 1);
+        }
+        for(auto const v: cache) {
+            if(v != tri[0] && v != tri[1] && v != tri[2]) {
+                nextCache.push_back(v);
+            }
+        }
+        for(size_t i = cacheSize; i < nextCache.size(); i++) {
+            vertexScores[nextCache[i]] = vertex_score(-1, remaining[nextCache[i]]);
+        }
+        nextCache.resize(std::min(nextCache.size(), cacheSize));
+        std::swap(cache, nextCache);
+
+        for(size_t i = 0; i != cache.size(); i++) {
+            vertexScores[cache[i]] = vertex_score(static_cast<int32_t>(i), remaining[cache[i]]);
+        }
+
+        best = triCount;
+        auto bestScore = -1.0f;
+        for(auto const v: cache) {
+            for(auto a = offsets[v]; a != offsets[v] + remaining[v]; a++) {
+                auto const t = adjacency[a];
+                auto const score = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+                if(score > bestScore) {
+                    bestScore = score;
+                    best = t;
+                }
+            }
+        }
+    }
+    std::copy(result.begin(), result.end(), indices);
+}
+
+void Rito::OptimizeOverdraw(uint32_t* indices, size_t indexCount,
+                            Vec3 const* positions, size_t vertexCount,
+                            float threshold) {
+    using namespace Rito::OptimizeImpl;
+    auto const triCount = indexCount / 3;
+    if(triCount < 2) {
+        return;
+    }
+
+    // Clusters start where a triangle misses the cache on every vertex, only kept if cluster stays efficient
+    auto fifo = Fifo { vertexCount };
+    size_t totalMisses = 0;
+    std::vector<uint8_t> misses(triCount);
+    for(size_t t = 0; t != triCount; t++) {
+        for(size_t c = 0; c != 3; c++) {
+            misses[t] += fifo.touch(indices[t * 3 + c]) ? 1 : 0;
+        }
+        totalMisses += misses[t];
+    }
+    auto const meshAcmr = static_cast<float>(totalMisses) / static_cast<float>(triCount);
+    std::vector<size_t> clusters = { 0 };
+    size_t clusterMisses = 0;
+    for(size_t t = 0; t != triCount; t++) {
+        auto const clusterTris = t - clusters.back();
+        if(t != 0 && misses[t] == 3 && clusterTris != 0) {
+            auto const clusterAcmr = static_cast<float>(clusterMisses) / static_cast<float>(clusterTris);
+            if(clusterAcmr <= meshAcmr * threshold) {
+                clusters.push_back(t);
+                clusterMisses = 0;
+            }
+        }
+        clusterMisses += misses[t];
+    }
+    clusters.push_back(triCount);
+    if(clusters.size() <= 2) {
+        return;
+    }
+
+    auto meshCenter = Vec3 {};
+    for(size_t v = 0; v != vertexCount; v++) {
+        meshCenter = { meshCenter.x + positions[v].x, meshCenter.y + positions[v].y, meshCenter.z + positions[v].z };
+    }
+    auto const invCount = 1.0f / static_cast<float>(std::max<size_t>(vertexCount, 1));
+    meshCenter = { meshCenter.x * invCount, meshCenter.y * invCount, meshCenter.z * invCount };
+
+    // Clusters facing outward from mesh center are drawn first as they tend to occlude the rest
+    std::vector<std::pair<float, size_t>> order;
+    order.reserve(clusters.size() - 1);
+    for(size_t c = 0; c + 1 != clusters.size(); c++) {
+        auto center = Vec3 {};
+        auto normal = Vec3 {};
+        auto area = 0.0f;
+        for(auto t = clusters[c]; t != clusters[c + 1]; t++) {
+            auto const& a = positions[indices[t * 3]];
+            auto const& b = positions[indices[t * 3 + 1]];
+            auto const& d = positions[indices[t * 3 + 2]];
+            auto const e0 = Vec3 { b.x - a.x, b.y - a.y, b.z - a.z };
+            auto const e1 = Vec3 { d.x - a.x, d.y - a.y, d.z - a.z };
+            auto const n = Vec3 { e0.y * e1.z - e0.z * e1.y, e0.z * e1.x - e0.x * e1.z, e0.x * e1.y - e0.y * e1.x };
+            auto const w = n.length();
+            center = {
+                center.x + (a.x + b.x + d.x) * w,
+                center.y + (a.y + b.y + d.y) * w,
+                center.z + (a.z + b.z + d.z) * w,
+            };
+            normal = { normal.x + n.x, normal.y + n.y, normal.z + n.z };
+            area += w;
+        }
+        auto const invArea = area > 0.0f ? 1.0f / (area * 3.0f) : 0.0f;
+        center = { center.x * invArea - meshCenter.x, center.y * invArea - meshCenter.y, center.z * invArea - meshCenter.z };
+        auto const normalLength = normal.length();
+        auto const key = normalLength > 0.0f
+                ? (center.x * normal.x + center.y * normal.y + center.z * normal.z) / normalLength
+                : 0.0f;
+        order.emplace_back(-key, c);
+    }
+    std::stable_sort(order.begin(), order.end(), [](auto const& l, auto const& r) {
+        return l.first < r.first;
+    });
+
+    std::vector<uint32_t> result;
+    result.reserve(triCount * 3);
+    for(auto const& [key, c]: order) {
+        result.insert(result.end(), indices + clusters[c] * 3, indices + clusters[c + 1] * 3);
+    }
+    std::copy(result.begin(), result.end(), indices);
+}
+
+std::vector<uint32_t> Rito::OptimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount) {
+    constexpr auto unused = ~uint32_t{0};
+    std::vector<uint32_t> remap(vertexCount, unused);
+    std::vector<uint32_t> order;
+    order.reserve(vertexCount);
+    for(size_t i = 0; i != indexCount; i++) {
+        file_assert(indices[i] < vertexCount);
+        auto& target = remap[indices[i]];
+        if(target == unused) {
+            target = static_cast<uint32_t>(order.size());
+            order.push_back(indices[i]);
+        }
+        indices[i] = target;
+    }
+    // Unreferenced vertices are kept at the end so vertex count does not change
+    for(uint32_t v = 0; v != vertexCount; v++) {
+        if(remap[v] == unused) {
+            remap[v] = static_cast<uint32_t>(order.size());
+            order.push_back(v);
+        }
+    }
+    return order;
+}
+
+namespace Rito::OptimizeImpl {
+    template<typename T>
+    inline void reorder(std::vector<T>& items, size_t first, std::vector<uint32_t> const& order) {
+        if(items.empty()) {
+            return;
+        }
+        std::vector<T> copy(items.begin() + static_cast<ptrdiff_t>(first),
+                            items.begin() + static_cast<ptrdiff_t>(first + order.size()));
+        for(size_t i = 0; i != order.size(); i++) {
+            items[first + i] = copy[order[i]];
+        }
+    }
+
+    inline bool overlaps(SimpleSkin::SubMesh const& a, SimpleSkin::SubMesh const& b) noexcept {
+        return a.firstVertex < b.firstVertex + b.vertexCount && b.firstVertex < a.firstVertex + a.vertexCount;
+    }
+}
+
+void Rito::OptimizeSkin(SimpleSkin& skn, OptimizeOptions const& options) {
+    using namespace Rito::OptimizeImpl;
+    auto submeshes = skn.submeshes;
+    if(submeshes.empty()) {
+        submeshes.push_back({
+                                {},
+                                0,
+                                static_cast<int32_t>(skn.vtxPositions.size()),
+                                0,
+                                static_cast<int32_t>(skn.indices.size())
+                            });
+    }
+
+    auto indices = skn.indices.widen();
+    for(auto const& submesh: submeshes) {
+        auto const firstVertex = static_cast<size_t>(submesh.firstVertex);
+        auto const vertexCount = static_cast<size_t>(submesh.vertexCount);
+        auto const firstIndex = static_cast<size_t>(submesh.firstIndex);
+        auto const indexCount = static_cast<size_t>(submesh.indexCount) / 3 * 3;
+        file_assert(firstVertex + vertexCount <= skn.vtxPositions.size());
+        file_assert(firstIndex + indexCount <= indices.size());
+
+        auto const local = indices.data() + firstIndex;
+        for(size_t i = 0; i != indexCount; i++) {
+            file_assert(local[i] >= firstVertex && local[i] - firstVertex < vertexCount);
+            local[i] -= static_cast<uint32_t>(firstVertex);
+        }
+        if(options.vertexCache) {
+            OptimizeVertexCache(local, indexCount, vertexCount);
+        }
+        if(options.overdraw) {
+            OptimizeOverdraw(local, indexCount, skn.vtxPositions.data() + firstVertex, vertexCount,
+                             options.overdrawThreshold);
+        }
+        // Vertices shared with another submesh can not be moved without breaking it
+        auto const shared = std::any_of(submeshes.begin(), submeshes.end(), [&](auto const& other) {
+            return &other != &submesh && overlaps(other, submesh);
+        });
+        if(options.vertexFetch && !shared) {
+            auto const order = OptimizeVertexFetch(local, indexCount, vertexCount);
+            reorder(skn.vtxPositions, firstVertex, order);
+            reorder(skn.vtxBlendIndices, firstVertex, order);
+            reorder(skn.vtxBlendWeights, firstVertex, order);
+            reorder(skn.vtxNormals, firstVertex, order);
+            reorder(skn.vtxUVs, firstVertex, order);
+            reorder(skn.vtxColors, firstVertex, order);
+        }
+        for(size_t i = 0; i != indexCount; i++) {
+            local[i] += static_cast<uint32_t>(firstVertex);
+        }
+    }
+
+    skn.indices.visit([&indices](auto& target) {
+        using T = typename std::remove_reference_t<decltype(target)>::value_type;
+        for(size_t i = 0; i != target.size(); i++) {
+            target[i] = static_cast<T>(indices[i]);
+        }
+    });
+}
@@ -0,0 +1,32 @@
+#ifndef RITO_OPTIMIZE_HPP
+#define RITO_OPTIMIZE_HPP
+#include <cinttypes>
+#include <vector>
+#include "types.hpp"
+#include "simpleskin.hpp"
+
+namespace Rito {
+    struct OptimizeOptions {
+        bool vertexCache = true;
+        bool overdraw = true;
+        bool vertexFetch = true;
+        // How much worse than the whole mesh a cluster's cache efficiency may get before overdraw order gives up on it
+        float overdrawThreshold = 1.05f;
+    };
+
+    // Indices are local to [0, vertexCount)
+    extern void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+    // Reorders triangle clusters front to back from the outside, expects vertex cache optimized input
+    extern void OptimizeOverdraw(uint32_t* indices, size_t indexCount,
+                                 Vec3 const* positions, size_t vertexCount,
+                                 float threshold);
+
+    // Renumbers vertices in order of first use and returns old index for every new index
+    extern std::vector<uint32_t> OptimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+    // Runs enabled passes on every submesh in place, submesh ranges stay the same
+    extern void OptimizeSkin(SimpleSkin& skn, OptimizeOptions const& options = {});
+}
+
+#endif // RITO_OPTIMIZE_HPP
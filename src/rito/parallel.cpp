@@ -0,0 +1,107 @@
+#include <deque>
+#include <thread>
+#include <vector>
+#include "parallel.hpp"
+
+using namespace Rito;
+
+namespace Rito::ParallelImpl {
+    struct Pool {
+        std::mutex lock = {};
+        std::condition_variable ready = {};
+        std::deque<std::shared_ptr<Task>> queue = {};
+        std::vector<std::thread> threads = {};
+        bool stopping = false;
+
+        Pool() {
+            auto const count = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+            threads.reserve(count);
+            for(size_t t = 0; t != count; t++) {
+                threads.emplace_back([this] { loop(); });
+            }
+        }
+
+        ~Pool() {
+            {
+                auto const locked = std::lock_guard(lock);
+                stopping = true;
+            }
+            ready.notify_all();
+            for(auto& thread: threads) {
+                thread.join();
+            }
+        }
+
+        void loop() {
+            for(;;) {
+                auto task = std::shared_ptr<Task> {};
+                {
+                    auto locked = std::unique_lock(lock);
+                    ready.wait(locked, [this] { return stopping || !queue.empty(); });
+                    if(stopping) {
+                        return;
+                    }
+                    task = std::move(queue.front());
+                    queue.pop_front();
+                }
+                task->work();
+            }
+        }
+
+        static Pool& get() {
+            static Pool pool = {};
+            return pool;
+        }
+    };
+}
+
+void ParallelImpl::Task::work() noexcept {
+    for(;;) {
+        // Counted as active before claiming so wait cannot return while a claimed chunk runs
+        active.fetch_add(1);
+        auto const begin = next.fetch_add(grain);
+        if(begin < count) {
+            try {
+                run(context, begin, std::min(begin + grain, count));
+            } catch(...) {
+                auto const locked = std::lock_guard(lock);
+                if(!error) {
+                    error = std::current_exception();
+                }
+                next = count;
+            }
+        }
+        if(active.fetch_sub(1) == 1) {
+            auto const locked = std::lock_guard(lock);
+            idle.notify_all();
+        }
+        if(begin >= count) {
+            return;
+        }
+    }
+}
+
+void ParallelImpl::Task::wait() noexcept {
+    auto locked = std::unique_lock(lock);
+    idle.wait(locked, [this] { return active.load() == 0; });
+}
+
+size_t ParallelImpl::worker_count() noexcept {
+    return Pool::get().threads.size();
+}
+
+void ParallelImpl::submit(std::shared_ptr<Task> const& task, size_t helpers) {
+    auto& pool = Pool::get();
+    helpers = std::min(helpers, pool.threads.size());
+    {
+        auto const locked = std::lock_guard(pool.lock);
+        for(size_t h = 0; h != helpers; h++) {
+            pool.queue.push_back(task);
+        }
+    }
+    if(helpers == 1) {
+        pool.ready.notify_one();
+    } else {
+        pool.ready.notify_all();
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef RITO_PARALLEL_HPP
+#define RITO_PARALLEL_HPP
+#include <cinttypes>
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
+namespace Rito::ParallelImpl {
+    // One parallel_for call, shared between the caller and the pool threads helping it
+    struct Task {
+        size_t count;
+        size_t grain;
+        // Points into the caller's frame, only dereferenced while a chunk is claimed
+        void* context;
+        void (*run)(void* context, size_t begin, size_t end);
+        std::atomic<size_t> next = 0;
+        std::atomic<size_t> active = 0;
+        std::exception_ptr error = {};
+        std::mutex lock = {};
+        std::condition_variable idle = {};
+
+        Task(size_t count, size_t grain, void* context, void (*run)(void*, size_t, size_t)) noexcept
+            : count(count), grain(grain), context(context), run(run) {}
+
+        // Claims chunks until none are left
+        void work() noexcept;
+
+        // Blocks until no thread is inside a chunk
+        void wait() noexcept;
+    };
+
+    // Threads in the shared pool, callers of parallel_for work alongside them
+    size_t worker_count() noexcept;
+
+    // Queues task on up to helpers pool threads, helpers that start after the task is done return at once
+    void submit(std::shared_ptr<Task> const& task, size_t helpers);
+}
+
+namespace Rito {
+    // Calls func(i) for every i in [0, count) on the calling thread and the shared worker pool.
+    // Work is handed out in chunks of grain, first exception thrown by any worker is rethrown.
+    // maxThreads caps the threads used including the caller, 0 uses all and 1 runs inline.
+    // Nested or concurrent calls share the pool instead of spawning more threads.
+    template<typename F>
+    inline void parallel_for(size_t count, F&& func, size_t grain = 1, size_t maxThreads = 0) {
+        grain = grain ? grain : 1;
+        auto const chunks = (count + grain - 1) / grain;
+        auto threadCount = std::min(ParallelImpl::worker_count() + 1, chunks);
+        if(maxThreads) {
+            threadCount = std::min(threadCount, maxThreads);
+        }
+        if(threadCount <= 1) {
+            for(size_t i = 0; i != count; i++) {
+                func(i);
+            }
+            return;
+        }
+
+        using Func = std::remove_reference_t<F>;
+        auto const task = std::make_shared<ParallelImpl::Task>(count, grain, const_cast<void*>(static_cast<void const*>(&func)),
+                                                               [](void* context, size_t begin, size_t end) {
+            auto& f = *static_cast<Func*>(context);
+            for(auto i = begin; i != end; i++) {
+                f(i);
+            }
+        });
+        ParallelImpl::submit(task, threadCount - 1);
+        task->work();
+        task->wait();
+        if(task->error) {
+            std::rethrow_exception(task->error);
+        }
+    }
+}
+
+#endif // RITO_PARALLEL_HPP
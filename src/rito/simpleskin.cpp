@@ -1,5 +1,12 @@
 ﻿#include <cstring>
+#include <cstddef>
 #include "simpleskin.hpp"
+#include "bounds.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define RITO_SIMD_SSE2
+#include <emmintrin.h>
+#endif
 
 using namespace Rito;
 
@@ -42,7 +49,7 @@ namespace Rito::SimpleSkinImpl {
         Sphere boundingSphere;
     };
 
-    inline void read(SimpleSkin& skn, File const& file) {
+    inline void read(SimpleSkinView& skn, File const& file) {
         auto const header = file.get<Header>();
         file_assert(header.magic == 0x00112233u);
         file_assert(header.version >= 0x10000u && header.version <= 0x10004u);
@@ -54,7 +61,7 @@ namespace Rito::SimpleSkinImpl {
             for(auto const& from: submeshes) {
                 auto [name, firstVertex, vertexCount, firstIndex, indexCount] = from;
                 auto& submesh = skn.submeshes.emplace_back();
-                submesh.name = name;
+                submesh.name = skn.strings->intern(name);
                 submesh.firstVertex = firstVertex >= 0 && vertexCount > 0 ? firstVertex : 0;
                 submesh.vertexCount = firstVertex >= 0 && vertexCount > 0 ? vertexCount : 0;
                 submesh.firstIndex = firstIndex >= 0 && indexCount > 0 ? firstIndex : 0;
@@ -73,38 +80,199 @@ namespace Rito::SimpleSkinImpl {
                     ? geometry.vertexSize == sizeof(VertexBasic)
                     : geometry.vertexSize == sizeof(VertexColor));
 
-        auto const indices = file.get<std::vector<uint16_t>>(geometry.old.numIndices);
-        skn.indices = { indices.begin(), indices.end() };
-
-        auto const vertices = file.get<std::vector<uint8_t>>(geometry.old.numVertices * geometry.vertexSize);
-        skn.vtxPositions.reserve(static_cast<size_t>(geometry.old.numVertices));
-        skn.vtxBlendIndices.reserve(static_cast<size_t>(geometry.old.numVertices));
-        skn.vtxBlendWeights.reserve(static_cast<size_t>(geometry.old.numVertices));
-        skn.vtxNormals.reserve(static_cast<size_t>(geometry.old.numVertices));
-        skn.vtxUVs.reserve(static_cast<size_t>(geometry.old.numVertices));
-        if(geometry.vertexType == 1) {
-            skn.vtxColors.reserve(static_cast<size_t>(geometry.old.numVertices));
+        skn.vertexCount = geometry.old.numVertices;
+        skn.vertexSize = geometry.vertexSize;
+        skn.vertexType = geometry.vertexType;
+        file.read(skn.indexData, geometry.old.numIndices);
+        file.read(skn.vertexData, geometry.old.numVertices * geometry.vertexSize);
+        skn.pivotPoint = file.get<Vec3>();
+        if (header.version > 0x10003u) {
+            skn.boundingBox = geometry.boundingBox;
+            skn.boundingSphere = geometry.boundingSphere;
+        } else {
+            auto const positions = skn.positions();
+            skn.boundingBox = ComputeBoundingBox(positions);
+            skn.boundingSphere = ComputeBoundingSphere(positions, skn.boundingBox);
         }
+    }
 
-        for(auto i = vertices.data();
-            i != vertices.data() + vertices.size();
-            i += geometry.vertexSize) {
-            VertexColor vtx;
-            memcpy(&vtx, i, static_cast<size_t>(geometry.vertexSize));
-            skn.vtxPositions.push_back(vtx.position);
-            skn.vtxBlendIndices.push_back(vtx.blendIndices);
-            skn.vtxBlendWeights.push_back(vtx.blendWeights);
-            skn.vtxNormals.push_back(vtx.normal);
-            skn.vtxUVs.push_back(vtx.textureCoord);
-            if(geometry.vertexType == 1) {
-                skn.vtxColors.push_back(vtx.color);
-            }
+    template<typename T>
+    inline Mem::Strided<T> strided(SimpleSkinView const& skn, size_t offset) noexcept {
+        return {
+            skn.vertexData.data() + offset,
+            static_cast<size_t>(skn.vertexSize),
+            static_cast<size_t>(skn.vertexCount)
+        };
+    }
+
+    struct Output {
+        float* positions;
+        uint32_t* blendIndices;
+        float* blendWeights;
+        float* normals;
+        float* uvs;
+        uint32_t* colors;
+    };
+
+    inline void deinterleave1(Output const& out, uint8_t const* vtx, size_t i) noexcept {
+        memcpy(out.positions + i * 3, vtx + offsetof(VertexBasic, position), sizeof(Vec3));
+        memcpy(out.blendIndices + i, vtx + offsetof(VertexBasic, blendIndices), sizeof(uint32_t));
+        memcpy(out.blendWeights + i * 4, vtx + offsetof(VertexBasic, blendWeights), sizeof(float) * 4);
+        memcpy(out.normals + i * 3, vtx + offsetof(VertexBasic, normal), sizeof(Vec3));
+        memcpy(out.uvs + i * 2, vtx + offsetof(VertexBasic, textureCoord), sizeof(Vec2));
+        if(out.colors) {
+            memcpy(out.colors + i, vtx + sizeof(VertexBasic), sizeof(ColorB));
         }
+    }
 
-        skn.pivotPoint = file.get<Vec3>();
+#ifdef RITO_SIMD_SSE2
+    // Packs xyz of 4 vectors, whose w lanes hold unrelated data, into 12 contiguous floats
+    inline void store_xyz4(float* dst, __m128 v0, __m128 v1, __m128 v2, __m128 v3) noexcept {
+        auto const a = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(0, 0, 2, 2));
+        auto const b = _mm_shuffle_ps(v2, v3, _MM_SHUFFLE(0, 0, 2, 2));
+        _mm_storeu_ps(dst + 0, _mm_shuffle_ps(v0, a, _MM_SHUFFLE(2, 0, 1, 0)));
+        _mm_storeu_ps(dst + 4, _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(1, 0, 2, 1)));
+        _mm_storeu_ps(dst + 8, _mm_shuffle_ps(b, v3, _MM_SHUFFLE(2, 1, 2, 0)));
+    }
+
+    inline __m128 load_uv2(uint8_t const* vtx0, uint8_t const* vtx1) noexcept {
+        constexpr auto offset = offsetof(VertexBasic, textureCoord);
+        auto const lo = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<__m64 const*>(vtx0 + offset));
+        return _mm_loadh_pi(lo, reinterpret_cast<__m64 const*>(vtx1 + offset));
+    }
+
+    inline uint32_t load_u32(uint8_t const* src) noexcept {
+        uint32_t result;
+        memcpy(&result, src, sizeof(uint32_t));
+        return result;
+    }
+
+    inline void deinterleave4(Output const& out, uint8_t const* vtx, size_t stride, size_t i) noexcept {
+        auto const v0 = vtx;
+        auto const v1 = vtx + stride;
+        auto const v2 = vtx + stride * 2;
+        auto const v3 = vtx + stride * 3;
+
+        // position.xyz with blendIndices in w
+        auto const p0 = _mm_loadu_ps(reinterpret_cast<float const*>(v0 + offsetof(VertexBasic, position)));
+        auto const p1 = _mm_loadu_ps(reinterpret_cast<float const*>(v1 + offsetof(VertexBasic, position)));
+        auto const p2 = _mm_loadu_ps(reinterpret_cast<float const*>(v2 + offsetof(VertexBasic, position)));
+        auto const p3 = _mm_loadu_ps(reinterpret_cast<float const*>(v3 + offsetof(VertexBasic, position)));
+        store_xyz4(out.positions + i * 3, p0, p1, p2, p3);
+        auto const w01 = _mm_unpackhi_ps(p0, p1);
+        auto const w23 = _mm_unpackhi_ps(p2, p3);
+        _mm_storeu_ps(reinterpret_cast<float*>(out.blendIndices + i), _mm_movehl_ps(w23, w01));
+
+        auto const weights = out.blendWeights + i * 4;
+        _mm_storeu_ps(weights + 0, _mm_loadu_ps(reinterpret_cast<float const*>(v0 + offsetof(VertexBasic, blendWeights))));
+        _mm_storeu_ps(weights + 4, _mm_loadu_ps(reinterpret_cast<float const*>(v1 + offsetof(VertexBasic, blendWeights))));
+        _mm_storeu_ps(weights + 8, _mm_loadu_ps(reinterpret_cast<float const*>(v2 + offsetof(VertexBasic, blendWeights))));
+        _mm_storeu_ps(weights + 12, _mm_loadu_ps(reinterpret_cast<float const*>(v3 + offsetof(VertexBasic, blendWeights))));
+
+        // normal.xyz with textureCoord.x in w
+        auto const n0 = _mm_loadu_ps(reinterpret_cast<float const*>(v0 + offsetof(VertexBasic, normal)));
+        auto const n1 = _mm_loadu_ps(reinterpret_cast<float const*>(v1 + offsetof(VertexBasic, normal)));
+        auto const n2 = _mm_loadu_ps(reinterpret_cast<float const*>(v2 + offsetof(VertexBasic, normal)));
+        auto const n3 = _mm_loadu_ps(reinterpret_cast<float const*>(v3 + offsetof(VertexBasic, normal)));
+        store_xyz4(out.normals + i * 3, n0, n1, n2, n3);
+
+        _mm_storeu_ps(out.uvs + i * 2 + 0, load_uv2(v0, v1));
+        _mm_storeu_ps(out.uvs + i * 2 + 4, load_uv2(v2, v3));
+
+        if(out.colors) {
+            auto const colors = _mm_setr_epi32(static_cast<int>(load_u32(v0 + sizeof(VertexBasic))),
+                                               static_cast<int>(load_u32(v1 + sizeof(VertexBasic))),
+                                               static_cast<int>(load_u32(v2 + sizeof(VertexBasic))),
+                                               static_cast<int>(load_u32(v3 + sizeof(VertexBasic))));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out.colors + i), colors);
+        }
+    }
+#endif
+
+    inline void deinterleave(SimpleSkin& skn, SimpleSkinView const& view) {
+        auto const numVertices = static_cast<size_t>(view.vertexCount);
+        auto const stride = static_cast<size_t>(view.vertexSize);
+        skn.vtxPositions.resize(numVertices);
+        skn.vtxBlendIndices.resize(numVertices);
+        skn.vtxBlendWeights.resize(numVertices);
+        skn.vtxNormals.resize(numVertices);
+        skn.vtxUVs.resize(numVertices);
+        if(view.vertexType == 1) {
+            skn.vtxColors.resize(numVertices);
+        }
+
+        auto const out = Output {
+            reinterpret_cast<float*>(skn.vtxPositions.data()),
+            reinterpret_cast<uint32_t*>(skn.vtxBlendIndices.data()),
+            reinterpret_cast<float*>(skn.vtxBlendWeights.data()),
+            reinterpret_cast<float*>(skn.vtxNormals.data()),
+            reinterpret_cast<float*>(skn.vtxUVs.data()),
+            view.vertexType == 1 ? reinterpret_cast<uint32_t*>(skn.vtxColors.data()) : nullptr,
+        };
+        auto const vertices = view.vertexData.data();
+        size_t i = 0;
+#ifdef RITO_SIMD_SSE2
+        for(; i + 4 <= numVertices; i += 4) {
+            deinterleave4(out, vertices + i * stride, stride, i);
+        }
+#endif
+        for(; i != numVertices; i++) {
+            deinterleave1(out, vertices + i * stride, i);
+        }
     }
 }
 
-SimpleSkin::SimpleSkin(File const& file) {
+SimpleSkin::SimpleSkin(File const& file, std::shared_ptr<StringPool> strings)
+    : SimpleSkin(SimpleSkinView { file, std::move(strings) }) {}
+
+SimpleSkin::SimpleSkin(SimpleSkinView const& view) {
+    submeshes = view.submeshes;
+    indices = view.indexData;
+    Rito::SimpleSkinImpl::deinterleave(*this, view);
+    pivotPoint = view.pivotPoint;
+    boundingBox = view.boundingBox;
+    boundingSphere = view.boundingSphere;
+    strings = view.strings;
+}
+
+SimpleSkin::SimpleSkin(SimpleSkinView&& view) {
+    submeshes = std::move(view.submeshes);
+    indices = std::move(view.indexData);
+    Rito::SimpleSkinImpl::deinterleave(*this, view);
+    pivotPoint = view.pivotPoint;
+    boundingBox = view.boundingBox;
+    boundingSphere = view.boundingSphere;
+    strings = std::move(view.strings);
+}
+
+SimpleSkinView::SimpleSkinView(File const& file, std::shared_ptr<StringPool> strings)
+    : strings(StringPool::shared_or_new(std::move(strings))) {
     Rito::SimpleSkinImpl::read(*this, file);
 }
+
+Mem::Strided<Vec3> SimpleSkinView::positions() const noexcept {
+    return Rito::SimpleSkinImpl::strided<Vec3>(*this, offsetof(SimpleSkinImpl::VertexBasic, position));
+}
+
+Mem::Strided<std::array<uint8_t, 4>> SimpleSkinView::blendIndices() const noexcept {
+    return Rito::SimpleSkinImpl::strided<std::array<uint8_t, 4>>(*this, offsetof(SimpleSkinImpl::VertexBasic, blendIndices));
+}
+
+Mem::Strided<std::array<float, 4>> SimpleSkinView::blendWeights() const noexcept {
+    return Rito::SimpleSkinImpl::strided<std::array<float, 4>>(*this, offsetof(SimpleSkinImpl::VertexBasic, blendWeights));
+}
+
+Mem::Strided<Vec3> SimpleSkinView::normals() const noexcept {
+    return Rito::SimpleSkinImpl::strided<Vec3>(*this, offsetof(SimpleSkinImpl::VertexBasic, normal));
+}
+
+Mem::Strided<Vec2> SimpleSkinView::uvs() const noexcept {
+    return Rito::SimpleSkinImpl::strided<Vec2>(*this, offsetof(SimpleSkinImpl::VertexBasic, textureCoord));
+}
+
+Mem::Strided<ColorB> SimpleSkinView::colors() const noexcept {
+    if(vertexType != 1) {
+        return {};
+    }
+    return Rito::SimpleSkinImpl::strided<ColorB>(*this, sizeof(SimpleSkinImpl::VertexBasic));
+}
@@ -2,20 +2,25 @@
 #define RITO_SIMPLESKIN_HPP
 #include "file.hpp"
 #include "types.hpp"
+#include "memory.hpp"
 #include <vector>
+#include <span>
 #include <algorithm>
 
 namespace Rito {
+    struct SimpleSkinView;
+
     struct SimpleSkin {
         struct SubMesh {
-            std::string name;
+            InternedString name;
             int32_t firstVertex;
             int32_t vertexCount;
             int32_t firstIndex;
             int32_t indexCount;
         };
         std::vector<SubMesh> submeshes;
-        std::vector<uint32_t> indices;
+        // Skins are limited to 16-bit indices, kept at that width
+        IndexBuffer indices;
         std::vector<Vec3> vtxPositions;
         std::vector<std::array<uint8_t, 4>> vtxBlendIndices;
         std::vector<std::array<float, 4>> vtxBlendWeights;
@@ -23,9 +28,49 @@ namespace Rito {
         std::vector<Vec2> vtxUVs;
         std::vector<ColorB> vtxColors;
         Vec3 pivotPoint;
+        // Stored since version 0x10004, computed from positions for older files
+        Box3D boundingBox;
+        Sphere boundingSphere;
+        // Pool of the submesh names
+        std::shared_ptr<StringPool> strings;
 
         SimpleSkin() noexcept = default;
-        SimpleSkin(File const& file);
+        // Names go into strings, a new pool when it is null
+        SimpleSkin(File const& file, std::shared_ptr<StringPool> strings = {});
+        // De-interleaves vertex stream of view
+        SimpleSkin(SimpleSkinView const& view);
+        // Same but takes submeshes and indices over instead of copying them
+        SimpleSkin(SimpleSkinView&& view);
+    };
+
+    // Skin with indices and interleaved vertices kept exactly as stored in file
+    struct SimpleSkinView {
+        std::vector<SimpleSkin::SubMesh> submeshes;
+        std::vector<uint16_t> indexData;
+        std::vector<uint8_t> vertexData;
+        int32_t vertexCount = {};
+        int32_t vertexSize = {};
+        uint32_t vertexType = {};
+        Vec3 pivotPoint = {};
+        Box3D boundingBox = {};
+        Sphere boundingSphere = {};
+        // Pool of the submesh names
+        std::shared_ptr<StringPool> strings = {};
+
+        // Names go into strings, a new pool when it is null
+        SimpleSkinView(File const& file, std::shared_ptr<StringPool> strings = {});
+
+        inline std::span<uint16_t const> indices() const noexcept {
+            return indexData;
+        }
+
+        Mem::Strided<Vec3> positions() const noexcept;
+        Mem::Strided<std::array<uint8_t, 4>> blendIndices() const noexcept;
+        Mem::Strided<std::array<float, 4>> blendWeights() const noexcept;
+        Mem::Strided<Vec3> normals() const noexcept;
+        Mem::Strided<Vec2> uvs() const noexcept;
+        // Empty unless vertexType is 1
+        Mem::Strided<ColorB> colors() const noexcept;
     };
 }
 
@@ -0,0 +1,439 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include "simplify.hpp"
+#include "parallel.hpp"
+
+using namespace Rito;
+
+namespace Rito::SimplifyImpl {
+    struct Quadric {
+        // Symmetric 4x4 matrix, upper triangle
+        std::array<double, 10> q = {};
+
+        static inline Quadric plane(double a, double b, double c, double d, double weight) noexcept {
+            return { {
+                a * a * weight, a * b * weight, a * c * weight, a * d * weight,
+                b * b * weight, b * c * weight, b * d * weight,
+                c * c * weight, c * d * weight,
+                d * d * weight
+            } };
+        }
+
+        inline Quadric& operator+=(Quadric const& other) noexcept {
+            for(size_t i = 0; i != q.size(); i++) {
+                q[i] += other.q[i];
+            }
+            return *this;
+        }
+
+        inline double error(Vec3 const& p) const noexcept {
+            double const x = p.x;
+            double const y = p.y;
+            double const z = p.z;
+            auto const e = q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x
+                    + q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y
+                    + q[7] * z * z + 2 * q[8] * z
+                    + q[9];
+            return std::max(e, 0.0);
+        }
+    };
+
+    struct Candidate {
+        double cost;
+        uint32_t from;
+        uint32_t to;
+        uint32_t version;
+
+        inline bool operator>(Candidate const& other) const noexcept {
+            return cost > other.cost;
+        }
+    };
+
+    inline Vec3 sub(Vec3 const& a, Vec3 const& b) noexcept {
+        return { a.x - b.x, a.y - b.y, a.z - b.z };
+    }
+
+    inline Vec3 cross(Vec3 const& a, Vec3 const& b) noexcept {
+        return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+    }
+
+    inline float dot(Vec3 const& a, Vec3 const& b) noexcept {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    // Penalty is a function of two vertex ids returning squared attribute distance
+    template<typename P>
+    std::vector<std::vector<uint32_t>> simplify(uint32_t const* indices, size_t indexCount,
+                                                Vec3 const* positions, size_t vertexCount,
+                                                SimplifyOptions const& options, P&& penalty) {
+        auto const triCount = indexCount / 3;
+        std::vector<std::array<uint32_t, 3>> tris(triCount);
+        std::vector<bool> alive(triCount, true);
+        std::vector<std::vector<uint32_t>> vertexTris(vertexCount);
+        auto constexpr inf = std::numeric_limits<float>::infinity();
+        auto lo = Vec3 { inf, inf, inf };
+        auto hi = Vec3 { -inf, -inf, -inf };
+        for(size_t t = 0; t != triCount; t++) {
+            for(size_t c = 0; c != 3; c++) {
+                auto const v = indices[t * 3 + c];
+                file_assert(v < vertexCount);
+                tris[t][c] = v;
+                auto const& p = positions[v];
+                lo = { std::min(lo.x, p.x), std::min(lo.y, p.y), std::min(lo.z, p.z) };
+                hi = { std::max(hi.x, p.x), std::max(hi.y, p.y), std::max(hi.z, p.z) };
+            }
+            // Triangles degenerate from the start are never emitted nor take part in collapses
+            auto const& tri = tris[t];
+            if(tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2]) {
+                alive[t] = false;
+                continue;
+            }
+            for(auto const v: tri) {
+                vertexTris[v].push_back(static_cast<uint32_t>(t));
+            }
+        }
+        auto const extent = static_cast<double>(sub(hi, lo).length());
+        auto const extent2 = std::max(extent * extent, 1e-12);
+        auto const maxCost = static_cast<double>(options.maxError) * static_cast<double>(options.maxError) * extent2;
+        auto const attributeScale = static_cast<double>(options.attributeWeight) * extent2;
+
+        std::vector<Quadric> quadrics(vertexCount);
+        for(size_t t = 0; t != triCount; t++) {
+            if(!alive[t]) {
+                continue;
+            }
+            auto const& tri = tris[t];
+            auto const& a = positions[tri[0]];
+            auto const n = cross(sub(positions[tri[1]], a), sub(positions[tri[2]], a));
+            auto const area = n.length();
+            if(area <= 0.0f) {
+                continue;
+            }
+            double const nx = n.x / area;
+            double const ny = n.y / area;
+            double const nz = n.z / area;
+            auto const d = -(nx * a.x + ny * a.y + nz * a.z);
+            auto const q = Quadric::plane(nx, ny, nz, d, area);
+            for(auto const v: tri) {
+                quadrics[v] += q;
+            }
+        }
+
+        // Vertices on edges used by a single triangle never move
+        std::vector<bool> locked(vertexCount, false);
+        {
+            std::vector<std::pair<uint64_t, uint32_t>> edges;
+            edges.reserve(triCount * 3);
+            for(size_t t = 0; t != triCount; t++) {
+                if(!alive[t]) {
+                    continue;
+                }
+                auto const& tri = tris[t];
+                for(size_t c = 0; c != 3; c++) {
+                    auto const a = tri[c];
+                    auto const b = tri[(c + 1) % 3];
+                    edges.emplace_back(uint64_t{std::min(a, b)} << 32 | std::max(a, b), 0);
+                }
+            }
+            std::sort(edges.begin(), edges.end());
+            for(size_t i = 0; i != edges.size();) {
+                auto j = i;
+                while(j != edges.size() && edges[j].first == edges[i].first) {
+                    j++;
+                }
+                if(j - i == 1) {
+                    locked[static_cast<uint32_t>(edges[i].first >> 32)] = true;
+                    locked[static_cast<uint32_t>(edges[i].first)] = true;
+                }
+                i = j;
+            }
+        }
+
+        std::vector<uint32_t> versions(vertexCount, 0);
+        std::vector<bool> removed(vertexCount, false);
+        std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> queue;
+        auto const cost = [&](uint32_t from, uint32_t to) {
+            auto q = quadrics[from];
+            q += quadrics[to];
+            return q.error(positions[to]) + attributeScale * penalty(from, to);
+        };
+        auto const push_around = [&](uint32_t v) {
+            for(auto const t: vertexTris[v]) {
+                if(!alive[t]) {
+                    continue;
+                }
+                for(auto const other: tris[t]) {
+                    if(other == v) {
+                        continue;
+                    }
+                    if(!locked[v]) {
+                        queue.push({ cost(v, other), v, other, versions[v] + versions[other] });
+                    }
+                    if(!locked[other]) {
+                        queue.push({ cost(other, v), other, v, versions[v] + versions[other] });
+                    }
+                }
+            }
+        };
+        for(uint32_t v = 0; v != vertexCount; v++) {
+            for(auto const t: vertexTris[v]) {
+                for(auto const other: tris[t]) {
+                    if(other != v && !locked[v]) {
+                        queue.push({ cost(v, other), v, other, 0 });
+                    }
+                }
+            }
+        }
+
+        // Moving from onto to must not flip any triangle that survives the collapse
+        auto const valid = [&](uint32_t from, uint32_t to) {
+            for(auto const t: vertexTris[from]) {
+                if(!alive[t]) {
+                    continue;
+                }
+                auto const& tri = tris[t];
+                if(tri[0] == to || tri[1] == to || tri[2] == to) {
+                    continue;
+                }
+                auto moved = std::array<Vec3, 3> {};
+                for(size_t c = 0; c != 3; c++) {
+                    moved[c] = positions[tri[c] == from ? to : tri[c]];
+                }
+                auto const before = cross(sub(positions[tri[1]], positions[tri[0]]), sub(positions[tri[2]], positions[tri[0]]));
+                auto const after = cross(sub(moved[1], moved[0]), sub(moved[2], moved[0]));
+                if(dot(before, after) <= 0.0f) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        auto liveTris = std::count(alive.begin(), alive.end(), true);
+        auto const sourceTris = static_cast<double>(liveTris);
+        std::vector<std::vector<uint32_t>> lods;
+        lods.reserve(options.ratios.size());
+        auto const emit = [&] {
+            auto& lod = lods.emplace_back();
+            lod.reserve(static_cast<size_t>(liveTris) * 3);
+            for(size_t t = 0; t != triCount; t++) {
+                if(alive[t]) {
+                    lod.insert(lod.end(), tris[t].begin(), tris[t].end());
+                }
+            }
+        };
+
+        for(auto const ratio: options.ratios) {
+            auto const target = static_cast<ptrdiff_t>(sourceTris * static_cast<double>(ratio));
+            while(liveTris > target && !queue.empty()) {
+                auto const candidate = queue.top();
+                queue.pop();
+                auto const [_, from, to, version] = candidate;
+                if(removed[from] || removed[to] || version != versions[from] + versions[to]) {
+                    continue;
+                }
+                if(candidate.cost > maxCost) {
+                    // Everything left in queue is at least as expensive
+                    while(!queue.empty()) {
+                        queue.pop();
+                    }
+                    break;
+                }
+                if(!valid(from, to)) {
+                    continue;
+                }
+
+                removed[from] = true;
+                quadrics[to] += quadrics[from];
+                for(auto const t: vertexTris[from]) {
+                    if(!alive[t]) {
+                        continue;
+                    }
+                    auto& tri = tris[t];
+                    if(tri[0] == to || tri[1] == to || tri[2] == to) {
+                        alive[t] = false;
+                        liveTris--;
+                        continue;
+                    }
+                    std::replace(tri.begin(), tri.end(), from, to);
+                    vertexTris[to].push_back(t);
+                }
+                vertexTris[from].clear();
+                versions[to]++;
+                for(auto const t: vertexTris[to]) {
+                    for(auto const v: tris[t]) {
+                        if(v != to) {
+                            versions[v]++;
+                        }
+                    }
+                }
+                std::erase_if(vertexTris[to], [&](uint32_t t) { return !alive[t]; });
+                push_around(to);
+            }
+            emit();
+        }
+        return lods;
+    }
+
+    inline float weight_of(std::array<uint8_t, 4> const& indices, std::array<float, 4> const& weights, uint8_t joint) noexcept {
+        auto w = 0.0f;
+        for(size_t k = 0; k != 4; k++) {
+            w += indices[k] == joint ? weights[k] : 0.0f;
+        }
+        return w;
+    }
+}
+
+std::vector<std::vector<uint32_t>> Rito::SimplifyLods(uint32_t const* indices, size_t indexCount,
+                                                      Vec3 const* positions, size_t vertexCount,
+                                                      SimplifyOptions const& options) {
+    return SimplifyImpl::simplify(indices, indexCount, positions, vertexCount, options, [](uint32_t, uint32_t) {
+        return 0.0;
+    });
+}
+
+std::vector<std::vector<IndexBuffer>> Rito::SimplifyLods(SimpleSkin const& skn, SimplifyOptions const& options) {
+    using namespace Rito::SimplifyImpl;
+    auto submeshes = skn.submeshes;
+    if(submeshes.empty()) {
+        submeshes.push_back({
+                                {},
+                                0,
+                                static_cast<int32_t>(skn.vtxPositions.size()),
+                                0,
+                                static_cast<int32_t>(skn.indices.size())
+                            });
+    }
+    auto const count = skn.vtxPositions.size();
+    file_assert(skn.vtxBlendIndices.size() == count && skn.vtxBlendWeights.size() == count);
+    std::vector<std::vector<IndexBuffer>> result(submeshes.size());
+    parallel_for(submeshes.size(), [&](size_t s) {
+        auto const& submesh = submeshes[s];
+        auto const firstIndex = static_cast<size_t>(submesh.firstIndex);
+        auto const indexCount = static_cast<size_t>(submesh.indexCount);
+        file_assert(firstIndex + indexCount <= skn.indices.size());
+        // Submesh works on its own compact vertex range so memory scales with the submesh, not the skin
+        std::vector<uint32_t> vertices(indexCount);
+        for(size_t i = 0; i != indexCount; i++) {
+            vertices[i] = skn.indices[firstIndex + i];
+            file_assert(vertices[i] < count);
+        }
+        std::sort(vertices.begin(), vertices.end());
+        vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+        std::vector<uint32_t> indices(indexCount);
+        for(size_t i = 0; i != indexCount; i++) {
+            auto const found = std::lower_bound(vertices.begin(), vertices.end(), skn.indices[firstIndex + i]);
+            indices[i] = static_cast<uint32_t>(found - vertices.begin());
+        }
+        std::vector<Vec3> positions(vertices.size());
+        for(size_t v = 0; v != vertices.size(); v++) {
+            positions[v] = skn.vtxPositions[vertices[v]];
+        }
+        // L1 distance between the two sparse joint weight sets
+        auto const penalty = [&skn, &vertices](uint32_t localA, uint32_t localB) {
+            auto const a = vertices[localA];
+            auto const b = vertices[localB];
+            auto const& ia = skn.vtxBlendIndices[a];
+            auto const& wa = skn.vtxBlendWeights[a];
+            auto const& ib = skn.vtxBlendIndices[b];
+            auto const& wb = skn.vtxBlendWeights[b];
+            auto joints = std::array<uint8_t, 8> {};
+            std::copy(ia.begin(), ia.end(), joints.begin());
+            std::copy(ib.begin(), ib.end(), joints.begin() + 4);
+            std::sort(joints.begin(), joints.end());
+            auto const end = std::unique(joints.begin(), joints.end());
+            auto d = 0.0f;
+            for(auto j = joints.begin(); j != end; j++) {
+                d += std::abs(weight_of(ia, wa, *j) - weight_of(ib, wb, *j));
+            }
+            return static_cast<double>(d) * static_cast<double>(d);
+        };
+        auto lods = simplify(indices.data(), indices.size(), positions.data(), positions.size(), options, penalty);
+        for(auto& lod: lods) {
+            for(auto& index: lod) {
+                index = vertices[index];
+            }
+            if(skn.indices.wide()) {
+                result[s].emplace_back(std::move(lod));
+            } else {
+                result[s].emplace_back(std::vector<uint16_t>(lod.begin(), lod.end()));
+            }
+        }
+    });
+    return result;
+}
+
+std::vector<std::vector<IndexBuffer>> Rito::SimplifyLods(MapGeo& map, File const& file, SimplifyOptions const& options) {
+    using namespace Rito::SimplifyImpl;
+    using Name = MapGeo::VertexElemGroup::Name;
+    using Format = MapGeo::VertexElemGroup::Format;
+    struct Attribute {
+        int32_t stream = -1;
+        int32_t offset = -1;
+    };
+    // Position and uv stream of every mesh, loaded up front as lazy buffers can not be shared between threads
+    std::vector<std::pair<Attribute, Attribute>> layouts(map.meshInfos.size());
+    for(size_t m = 0; m != map.meshInfos.size(); m++) {
+        auto const& meshInfo = map.meshInfos[m];
+        auto& [position, uv] = layouts[m];
+        for(size_t s = 0; s != meshInfo.vertexBuffers.size(); s++) {
+            file_assert(meshInfo.vertexElemGroup + s < map.vertexElemGroups.size());
+            file_assert(meshInfo.vertexBuffers[s] < map.vertexBuffers.size());
+            auto const& group = map.vertexElemGroups[meshInfo.vertexElemGroup + s];
+            if(auto const offset = group.offset_of(Name::Position, Format::XYZ_Float32); offset != -1) {
+                position = { static_cast<int32_t>(s), offset };
+                map.vertexBuffers[meshInfo.vertexBuffers[s]].get(file);
+            }
+            if(auto const offset = group.offset_of(Name::Texcoord0, Format::XY_Float32); offset != -1) {
+                uv = { static_cast<int32_t>(s), offset };
+                map.vertexBuffers[meshInfo.vertexBuffers[s]].get(file);
+            }
+        }
+        file_assert(meshInfo.indexBuffer < map.indexBuffers.size());
+        map.indexBuffers[meshInfo.indexBuffer].get(file);
+    }
+
+    auto const extract = [&map](MapGeo::MeshInfo const& meshInfo, Attribute attribute, auto* out) {
+        auto const stream = static_cast<size_t>(attribute.stream);
+        auto const& group = map.vertexElemGroups[meshInfo.vertexElemGroup + stream];
+        auto const& vertices = map.vertexBuffers[meshInfo.vertexBuffers[stream]].items;
+        auto const stride = group.size();
+        file_assert(stride * meshInfo.vertexCount <= vertices.size());
+        for(size_t v = 0; v != meshInfo.vertexCount; v++) {
+            memcpy(out + v, vertices.data() + v * stride + static_cast<size_t>(attribute.offset), sizeof(*out));
+        }
+    };
+
+    std::vector<std::vector<IndexBuffer>> result(map.meshInfos.size());
+    parallel_for(map.meshInfos.size(), [&](size_t m) {
+        auto const& meshInfo = map.meshInfos[m];
+        auto const& [position, uv] = layouts[m];
+        if(position.stream == -1) {
+            return;
+        }
+        std::vector<Vec3> positions(meshInfo.vertexCount);
+        extract(meshInfo, position, positions.data());
+        std::vector<Vec2> uvs;
+        if(uv.stream != -1) {
+            uvs.resize(meshInfo.vertexCount);
+            extract(meshInfo, uv, uvs.data());
+        }
+        auto const& source = map.indexBuffers[meshInfo.indexBuffer].items;
+        file_assert(meshInfo.indexCount <= source.size());
+        std::vector<uint32_t> indices(source.begin(), source.begin() + meshInfo.indexCount);
+        auto const penalty = [&uvs](uint32_t a, uint32_t b) {
+            if(uvs.empty()) {
+                return 0.0;
+            }
+            auto const du = static_cast<double>(uvs[a].x - uvs[b].x);
+            auto const dv = static_cast<double>(uvs[a].y - uvs[b].y);
+            return du * du + dv * dv;
+        };
+        auto lods = simplify(indices.data(), indices.size(), positions.data(), positions.size(), options, penalty);
+        for(auto& lod: lods) {
+            result[m].emplace_back(std::vector<uint16_t>(lod.begin(), lod.end()));
+        }
+    }, 16);
+    return result;
+}
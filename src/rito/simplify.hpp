@@ -0,0 +1,37 @@
+#ifndef RITO_SIMPLIFY_HPP
+#define RITO_SIMPLIFY_HPP
+#include <cinttypes>
+#include <limits>
+#include <vector>
+#include "types.hpp"
+#include "file.hpp"
+#include "simpleskin.hpp"
+#include "mapgeo.hpp"
+
+namespace Rito {
+    struct SimplifyOptions {
+        // Triangle count of every LOD relative to the source, in decreasing order
+        std::vector<float> ratios = { 0.5f, 0.25f, 0.125f };
+        // Scales cost of merging vertices with different skin weights or uvs
+        float attributeWeight = 0.01f;
+        // Collapses stop once error, relative to mesh extent, exceeds this
+        float maxError = std::numeric_limits<float>::infinity();
+    };
+
+    // Quadric error edge collapse, collapses only move vertices onto existing ones so every
+    // LOD indexes the source vertices. Open boundaries, and with them uv/skin seams, are kept.
+    // Returns one index list per ratio.
+    extern std::vector<std::vector<uint32_t>> SimplifyLods(uint32_t const* indices, size_t indexCount,
+                                                           Vec3 const* positions, size_t vertexCount,
+                                                           SimplifyOptions const& options = {});
+
+    // Per submesh LOD chains over the skin's own vertex buffer, collapses respect blend weights
+    extern std::vector<std::vector<IndexBuffer>> SimplifyLods(SimpleSkin const& skn,
+                                                              SimplifyOptions const& options = {});
+
+    // Per mesh info LOD chains in mesh local vertex space, collapses respect Texcoord0
+    extern std::vector<std::vector<IndexBuffer>> SimplifyLods(MapGeo& map, File const& file,
+                                                              SimplifyOptions const& options = {});
+}
+
+#endif // RITO_SIMPLIFY_HPP
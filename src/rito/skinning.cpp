@@ -0,0 +1,402 @@
+#include <cstring>
+#include "skinning.hpp"
+#include "parallel.hpp"
+
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#define RITO_SIMD_AVX2
+#include <immintrin.h>
+#endif
+
+using namespace Rito;
+
+namespace Rito::SkinningImpl {
+    constexpr size_t blockSize = 4096;
+
+    // Top 3 rows of a matrix, 12 floats per joint
+    using Palette = std::vector<std::array<float, 12>>;
+
+    // Real xyzw followed by dual xyzw, 8 floats per joint
+    using DualQuatPalette = std::vector<std::array<float, 8>>;
+
+    struct Range {
+        size_t begin;
+        size_t end;
+    };
+
+    inline Palette make_palette(std::vector<Mtx44> const& matrices) {
+        Palette palette(matrices.size());
+        for(size_t i = 0; i != matrices.size(); i++) {
+            memcpy(palette[i].data(), &matrices[i], sizeof(float) * 12);
+        }
+        return palette;
+    }
+
+    inline DualQuatPalette make_dualquat_palette(std::vector<Mtx44> const& matrices) {
+        DualQuatPalette palette(matrices.size());
+        for(size_t i = 0; i != matrices.size(); i++) {
+            auto const& m = matrices[i];
+            auto q = Quat {};
+            auto const trace = m[0][0] + m[1][1] + m[2][2];
+            if(trace > 0.0f) {
+                auto const s = 0.5f / std::sqrt(trace + 1.0f);
+                q = { (m[2][1] - m[1][2]) * s, (m[0][2] - m[2][0]) * s, (m[1][0] - m[0][1]) * s, 0.25f / s };
+            } else if(m[0][0] > m[1][1] && m[0][0] > m[2][2]) {
+                auto const s = 2.0f * std::sqrt(1.0f + m[0][0] - m[1][1] - m[2][2]);
+                q = { 0.25f * s, (m[0][1] + m[1][0]) / s, (m[0][2] + m[2][0]) / s, (m[2][1] - m[1][2]) / s };
+            } else if(m[1][1] > m[2][2]) {
+                auto const s = 2.0f * std::sqrt(1.0f + m[1][1] - m[0][0] - m[2][2]);
+                q = { (m[0][1] + m[1][0]) / s, 0.25f * s, (m[1][2] + m[2][1]) / s, (m[0][2] - m[2][0]) / s };
+            } else {
+                auto const s = 2.0f * std::sqrt(1.0f + m[2][2] - m[0][0] - m[1][1]);
+                q = { (m[0][2] + m[2][0]) / s, (m[1][2] + m[2][1]) / s, 0.25f * s, (m[1][0] - m[0][1]) / s };
+            }
+            q = q.normalize();
+            auto const tx = m[0][3];
+            auto const ty = m[1][3];
+            auto const tz = m[2][3];
+            palette[i] = {
+                q.x, q.y, q.z, q.w,
+                0.5f * (tx * q.w + ty * q.z - tz * q.y),
+                0.5f * (-tx * q.z + ty * q.w + tz * q.x),
+                0.5f * (tx * q.y - ty * q.x + tz * q.w),
+                -0.5f * (tx * q.x + ty * q.y + tz * q.z),
+            };
+        }
+        return palette;
+    }
+
+    // Splits vertices into disjoint blocks that never cross a submesh boundary
+    inline std::vector<Range> make_ranges(SimpleSkin const& skn) {
+        auto const count = skn.vtxPositions.size();
+        std::vector<size_t> bounds = { 0, count };
+        for(auto const& submesh: skn.submeshes) {
+            auto const begin = static_cast<size_t>(submesh.firstVertex);
+            bounds.push_back(std::min(begin, count));
+            bounds.push_back(std::min(begin + static_cast<size_t>(submesh.vertexCount), count));
+        }
+        std::sort(bounds.begin(), bounds.end());
+        bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+        std::vector<Range> ranges;
+        for(size_t b = 1; b < bounds.size(); b++) {
+            for(auto i = bounds[b - 1]; i < bounds[b]; i += blockSize) {
+                ranges.push_back({ i, std::min(i + blockSize, bounds[b]) });
+            }
+        }
+        return ranges;
+    }
+
+    inline Vec3 normalize(float x, float y, float z) noexcept {
+        auto const l = std::sqrt(x * x + y * y + z * z);
+        return l > 0.0f ? Vec3 { x / l, y / l, z / l } : Vec3 { x, y, z };
+    }
+
+    inline void skin_linear1(SimpleSkin const& skn, Palette const& palette, SkinnedVertices& out, size_t v) {
+        auto const& indices = skn.vtxBlendIndices[v];
+        auto const& weights = skn.vtxBlendWeights[v];
+        std::array<float, 12> m = {};
+        for(size_t k = 0; k != 4; k++) {
+            // Compacted skins have most slots zeroed, see CompactWeights
+            if(weights[k] == 0.0f) {
+                continue;
+            }
+            auto const& joint = palette[indices[k]];
+            for(size_t e = 0; e != 12; e++) {
+                m[e] += joint[e] * weights[k];
+            }
+        }
+        auto const& p = skn.vtxPositions[v];
+        auto const& n = skn.vtxNormals[v];
+        out.positions[v] = {
+            m[0] * p.x + m[1] * p.y + m[2] * p.z + m[3],
+            m[4] * p.x + m[5] * p.y + m[6] * p.z + m[7],
+            m[8] * p.x + m[9] * p.y + m[10] * p.z + m[11],
+        };
+        out.normals[v] = normalize(m[0] * n.x + m[1] * n.y + m[2] * n.z,
+                                   m[4] * n.x + m[5] * n.y + m[6] * n.z,
+                                   m[8] * n.x + m[9] * n.y + m[10] * n.z);
+    }
+
+#ifdef RITO_SIMD_AVX2
+    // Number of influences that have to be gathered for 8 vertices:
+    // 1 when every vertex only has weight in its first slot, 4 otherwise
+    inline int influences8(SimpleSkin const& skn, size_t v) noexcept {
+        auto const weights = reinterpret_cast<float const*>(skn.vtxBlendWeights.data() + v);
+        auto const rest = _mm256_castsi256_ps(_mm256_setr_epi32(0, -1, -1, -1, 0, -1, -1, -1));
+        auto any = _mm256_setzero_ps();
+        for(size_t i = 0; i != 4; i++) {
+            any = _mm256_or_ps(any, _mm256_and_ps(_mm256_loadu_ps(weights + i * 8), rest));
+        }
+        auto const bits = _mm256_castps_si256(any);
+        return _mm256_testz_si256(bits, bits) ? 1 : 4;
+    }
+
+    // Skins 8 vertices at once, every lane gathers its own joint matrices
+    inline void skin_linear8(SimpleSkin const& skn, Palette const& palette, SkinnedVertices& out, size_t v) {
+        auto const lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        auto const packed = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(skn.vtxBlendIndices.data() + v));
+        auto const weights = reinterpret_cast<float const*>(skn.vtxBlendWeights.data() + v);
+        auto const matrices = palette.front().data();
+
+        __m256 m[12];
+        for(auto& e: m) {
+            e = _mm256_setzero_ps();
+        }
+        auto const influences = influences8(skn, v);
+        for(int k = 0; k != influences; k++) {
+            auto const joint = _mm256_and_si256(_mm256_srli_epi32(packed, k * 8), _mm256_set1_epi32(0xFF));
+            auto const base = _mm256_mullo_epi32(joint, _mm256_set1_epi32(12));
+            auto const weightIndex = _mm256_add_epi32(_mm256_slli_epi32(lanes, 2), _mm256_set1_epi32(k));
+            auto const w = _mm256_i32gather_ps(weights, weightIndex, 4);
+            for(int e = 0; e != 12; e++) {
+                auto const value = _mm256_i32gather_ps(matrices + e, base, 4);
+                m[e] = _mm256_fmadd_ps(value, w, m[e]);
+            }
+        }
+
+        auto const xyz = _mm256_mullo_epi32(lanes, _mm256_set1_epi32(3));
+        auto const positions = reinterpret_cast<float const*>(skn.vtxPositions.data() + v);
+        auto const px = _mm256_i32gather_ps(positions + 0, xyz, 4);
+        auto const py = _mm256_i32gather_ps(positions + 1, xyz, 4);
+        auto const pz = _mm256_i32gather_ps(positions + 2, xyz, 4);
+        auto const normals = reinterpret_cast<float const*>(skn.vtxNormals.data() + v);
+        auto const nx = _mm256_i32gather_ps(normals + 0, xyz, 4);
+        auto const ny = _mm256_i32gather_ps(normals + 1, xyz, 4);
+        auto const nz = _mm256_i32gather_ps(normals + 2, xyz, 4);
+
+        auto const row = [&](size_t r, __m256 x, __m256 y, __m256 z, __m256 w) {
+            return _mm256_fmadd_ps(m[r * 4 + 0], x, _mm256_fmadd_ps(m[r * 4 + 1], y, _mm256_fmadd_ps(m[r * 4 + 2], z, w)));
+        };
+        alignas(32) std::array<std::array<float, 8>, 6> result;
+        _mm256_store_ps(result[0].data(), row(0, px, py, pz, m[3]));
+        _mm256_store_ps(result[1].data(), row(1, px, py, pz, m[7]));
+        _mm256_store_ps(result[2].data(), row(2, px, py, pz, m[11]));
+        auto const zero = _mm256_setzero_ps();
+        auto const tx = row(0, nx, ny, nz, zero);
+        auto const ty = row(1, nx, ny, nz, zero);
+        auto const tz = row(2, nx, ny, nz, zero);
+        auto const length2 = _mm256_fmadd_ps(tx, tx, _mm256_fmadd_ps(ty, ty, _mm256_mul_ps(tz, tz)));
+        auto const valid = _mm256_cmp_ps(length2, zero, _CMP_GT_OQ);
+        auto const scale = _mm256_blendv_ps(_mm256_set1_ps(1.0f),
+                                            _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(length2)),
+                                            valid);
+        _mm256_store_ps(result[3].data(), _mm256_mul_ps(tx, scale));
+        _mm256_store_ps(result[4].data(), _mm256_mul_ps(ty, scale));
+        _mm256_store_ps(result[5].data(), _mm256_mul_ps(tz, scale));
+        for(size_t l = 0; l != 8; l++) {
+            out.positions[v + l] = { result[0][l], result[1][l], result[2][l] };
+            out.normals[v + l] = { result[3][l], result[4][l], result[5][l] };
+        }
+    }
+#endif
+
+    inline void skin_linear(SimpleSkin const& skn, Palette const& palette, SkinnedVertices& out, Range range) {
+        auto v = range.begin;
+#ifdef RITO_SIMD_AVX2
+        for(; v + 8 <= range.end; v += 8) {
+            skin_linear8(skn, palette, out, v);
+        }
+#endif
+        for(; v != range.end; v++) {
+            skin_linear1(skn, palette, out, v);
+        }
+    }
+
+    inline void skin_dualquat1(SimpleSkin const& skn, DualQuatPalette const& palette, SkinnedVertices& out, size_t v) {
+        auto const& indices = skn.vtxBlendIndices[v];
+        auto const& weights = skn.vtxBlendWeights[v];
+        auto const& first = palette[indices[0]];
+        std::array<float, 8> b = {};
+        for(size_t k = 0; k != 4; k++) {
+            if(weights[k] == 0.0f) {
+                continue;
+            }
+            auto const& joint = palette[indices[k]];
+            auto const dot = joint[0] * first[0] + joint[1] * first[1] + joint[2] * first[2] + joint[3] * first[3];
+            // Keep every quaternion in the same hemisphere as the first to take the shortest path
+            auto const w = dot < 0.0f ? -weights[k] : weights[k];
+            for(size_t e = 0; e != 8; e++) {
+                b[e] += joint[e] * w;
+            }
+        }
+        auto const length = std::sqrt(b[0] * b[0] + b[1] * b[1] + b[2] * b[2] + b[3] * b[3]);
+        auto const scale = length > 0.0f ? 1.0f / length : 0.0f;
+        for(auto& e: b) {
+            e *= scale;
+        }
+        auto const [rx, ry, rz, rw, dx, dy, dz, dw] = b;
+        auto const rotate = [&](Vec3 const& p) {
+            auto const cx = ry * p.z - rz * p.y + rw * p.x;
+            auto const cy = rz * p.x - rx * p.z + rw * p.y;
+            auto const cz = rx * p.y - ry * p.x + rw * p.z;
+            return Vec3 {
+                p.x + 2.0f * (ry * cz - rz * cy),
+                p.y + 2.0f * (rz * cx - rx * cz),
+                p.z + 2.0f * (rx * cy - ry * cx),
+            };
+        };
+        auto const p = rotate(skn.vtxPositions[v]);
+        out.positions[v] = {
+            p.x + 2.0f * (rw * dx - dw * rx + ry * dz - rz * dy),
+            p.y + 2.0f * (rw * dy - dw * ry + rz * dx - rx * dz),
+            p.z + 2.0f * (rw * dz - dw * rz + rx * dy - ry * dx),
+        };
+        auto const n = rotate(skn.vtxNormals[v]);
+        out.normals[v] = normalize(n.x, n.y, n.z);
+    }
+
+#ifdef RITO_SIMD_AVX2
+    inline void skin_dualquat8(SimpleSkin const& skn, DualQuatPalette const& palette, SkinnedVertices& out, size_t v) {
+        auto const lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        auto const packed = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(skn.vtxBlendIndices.data() + v));
+        auto const weights = reinterpret_cast<float const*>(skn.vtxBlendWeights.data() + v);
+        auto const quats = palette.front().data();
+        auto const signBit = _mm256_set1_ps(-0.0f);
+        auto const zero = _mm256_setzero_ps();
+
+        __m256 b[8];
+        __m256 first[4];
+        for(auto& e: b) {
+            e = _mm256_setzero_ps();
+        }
+        auto const influences = influences8(skn, v);
+        for(int k = 0; k != influences; k++) {
+            auto const joint = _mm256_and_si256(_mm256_srli_epi32(packed, k * 8), _mm256_set1_epi32(0xFF));
+            auto const base = _mm256_slli_epi32(joint, 3);
+            auto const weightIndex = _mm256_add_epi32(_mm256_slli_epi32(lanes, 2), _mm256_set1_epi32(k));
+            auto w = _mm256_i32gather_ps(weights, weightIndex, 4);
+            __m256 q[8];
+            for(int e = 0; e != 8; e++) {
+                q[e] = _mm256_i32gather_ps(quats + e, base, 4);
+            }
+            if(k == 0) {
+                for(int e = 0; e != 4; e++) {
+                    first[e] = q[e];
+                }
+            } else {
+                auto const dot = _mm256_fmadd_ps(q[0], first[0], _mm256_fmadd_ps(q[1], first[1],
+                                 _mm256_fmadd_ps(q[2], first[2], _mm256_mul_ps(q[3], first[3]))));
+                w = _mm256_xor_ps(w, _mm256_and_ps(_mm256_cmp_ps(dot, zero, _CMP_LT_OQ), signBit));
+            }
+            for(int e = 0; e != 8; e++) {
+                b[e] = _mm256_fmadd_ps(q[e], w, b[e]);
+            }
+        }
+        auto const length2 = _mm256_fmadd_ps(b[0], b[0], _mm256_fmadd_ps(b[1], b[1],
+                             _mm256_fmadd_ps(b[2], b[2], _mm256_mul_ps(b[3], b[3]))));
+        auto const scale = _mm256_and_ps(_mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(length2)),
+                                         _mm256_cmp_ps(length2, zero, _CMP_GT_OQ));
+        for(auto& e: b) {
+            e = _mm256_mul_ps(e, scale);
+        }
+        auto const two = _mm256_set1_ps(2.0f);
+        auto const& rx = b[0];
+        auto const& ry = b[1];
+        auto const& rz = b[2];
+        auto const& rw = b[3];
+        auto const& dx = b[4];
+        auto const& dy = b[5];
+        auto const& dz = b[6];
+        auto const& dw = b[7];
+        auto const rotate = [&](__m256 px, __m256 py, __m256 pz, __m256 (&r)[3]) {
+            auto const cx = _mm256_fmadd_ps(rw, px, _mm256_fmsub_ps(ry, pz, _mm256_mul_ps(rz, py)));
+            auto const cy = _mm256_fmadd_ps(rw, py, _mm256_fmsub_ps(rz, px, _mm256_mul_ps(rx, pz)));
+            auto const cz = _mm256_fmadd_ps(rw, pz, _mm256_fmsub_ps(rx, py, _mm256_mul_ps(ry, px)));
+            r[0] = _mm256_fmadd_ps(two, _mm256_fmsub_ps(ry, cz, _mm256_mul_ps(rz, cy)), px);
+            r[1] = _mm256_fmadd_ps(two, _mm256_fmsub_ps(rz, cx, _mm256_mul_ps(rx, cz)), py);
+            r[2] = _mm256_fmadd_ps(two, _mm256_fmsub_ps(rx, cy, _mm256_mul_ps(ry, cx)), pz);
+        };
+
+        auto const xyz = _mm256_mullo_epi32(lanes, _mm256_set1_epi32(3));
+        auto const positions = reinterpret_cast<float const*>(skn.vtxPositions.data() + v);
+        auto const normals = reinterpret_cast<float const*>(skn.vtxNormals.data() + v);
+        __m256 p[3];
+        __m256 n[3];
+        rotate(_mm256_i32gather_ps(positions + 0, xyz, 4),
+               _mm256_i32gather_ps(positions + 1, xyz, 4),
+               _mm256_i32gather_ps(positions + 2, xyz, 4),
+               p);
+        rotate(_mm256_i32gather_ps(normals + 0, xyz, 4),
+               _mm256_i32gather_ps(normals + 1, xyz, 4),
+               _mm256_i32gather_ps(normals + 2, xyz, 4),
+               n);
+        auto const tx = _mm256_fmadd_ps(rw, dx, _mm256_fnmadd_ps(dw, rx, _mm256_fmsub_ps(ry, dz, _mm256_mul_ps(rz, dy))));
+        auto const ty = _mm256_fmadd_ps(rw, dy, _mm256_fnmadd_ps(dw, ry, _mm256_fmsub_ps(rz, dx, _mm256_mul_ps(rx, dz))));
+        auto const tz = _mm256_fmadd_ps(rw, dz, _mm256_fnmadd_ps(dw, rz, _mm256_fmsub_ps(rx, dy, _mm256_mul_ps(ry, dx))));
+        auto const nlength2 = _mm256_fmadd_ps(n[0], n[0], _mm256_fmadd_ps(n[1], n[1], _mm256_mul_ps(n[2], n[2])));
+        auto const nscale = _mm256_blendv_ps(_mm256_set1_ps(1.0f),
+                                             _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(nlength2)),
+                                             _mm256_cmp_ps(nlength2, zero, _CMP_GT_OQ));
+
+        alignas(32) std::array<std::array<float, 8>, 6> result;
+        _mm256_store_ps(result[0].data(), _mm256_fmadd_ps(two, tx, p[0]));
+        _mm256_store_ps(result[1].data(), _mm256_fmadd_ps(two, ty, p[1]));
+        _mm256_store_ps(result[2].data(), _mm256_fmadd_ps(two, tz, p[2]));
+        _mm256_store_ps(result[3].data(), _mm256_mul_ps(n[0], nscale));
+        _mm256_store_ps(result[4].data(), _mm256_mul_ps(n[1], nscale));
+        _mm256_store_ps(result[5].data(), _mm256_mul_ps(n[2], nscale));
+        for(size_t l = 0; l != 8; l++) {
+            out.positions[v + l] = { result[0][l], result[1][l], result[2][l] };
+            out.normals[v + l] = { result[3][l], result[4][l], result[5][l] };
+        }
+    }
+#endif
+
+    inline void skin_dualquat(SimpleSkin const& skn, DualQuatPalette const& palette, SkinnedVertices& out, Range range) {
+        auto v = range.begin;
+#ifdef RITO_SIMD_AVX2
+        for(; v + 8 <= range.end; v += 8) {
+            skin_dualquat8(skn, palette, out, v);
+        }
+#endif
+        for(; v != range.end; v++) {
+            skin_dualquat1(skn, palette, out, v);
+        }
+    }
+
+    inline void validate(SimpleSkin const& skn, size_t jointCount) {
+        auto const count = skn.vtxPositions.size();
+        file_assert(skn.vtxNormals.size() == count);
+        file_assert(skn.vtxBlendIndices.size() == count);
+        file_assert(skn.vtxBlendWeights.size() == count);
+        for(auto const& indices: skn.vtxBlendIndices) {
+            for(auto const index: indices) {
+                file_assert(index < jointCount);
+            }
+        }
+    }
+}
+
+std::vector<Mtx44> Rito::SkinMatrices(Skeleton const& skl, std::vector<Mtx44> const& globalPose) {
+    file_assert(globalPose.size() == skl.joints.size());
+    std::vector<Mtx44> result;
+    result.reserve(skl.joints.size());
+    for(size_t i = 0; i != skl.joints.size(); i++) {
+        result.push_back(globalPose[i].mul(skl.joints[i].invRootOffset));
+    }
+    return result;
+}
+
+void Rito::SkinLinear(SimpleSkin const& skn, std::vector<Mtx44> const& matrices, SkinnedVertices& out) {
+    using namespace Rito::SkinningImpl;
+    auto const palette = make_palette(matrices);
+    validate(skn, palette.size());
+    out.positions.resize(skn.vtxPositions.size());
+    out.normals.resize(skn.vtxPositions.size());
+    auto const ranges = make_ranges(skn);
+    parallel_for(ranges.size(), [&](size_t r) {
+        skin_linear(skn, palette, out, ranges[r]);
+    });
+}
+
+void Rito::SkinDualQuat(SimpleSkin const& skn, std::vector<Mtx44> const& matrices, SkinnedVertices& out) {
+    using namespace Rito::SkinningImpl;
+    auto const palette = make_dualquat_palette(matrices);
+    validate(skn, palette.size());
+    out.positions.resize(skn.vtxPositions.size());
+    out.normals.resize(skn.vtxPositions.size());
+    auto const ranges = make_ranges(skn);
+    parallel_for(ranges.size(), [&](size_t r) {
+        skin_dualquat(skn, palette, out, ranges[r]);
+    });
+}
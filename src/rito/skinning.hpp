@@ -0,0 +1,28 @@
+#ifndef RITO_SKINNING_HPP
+#define RITO_SKINNING_HPP
+#include <cinttypes>
+#include <vector>
+#include "types.hpp"
+#include "simpleskin.hpp"
+#include "skeleton.hpp"
+
+namespace Rito {
+    struct SkinnedVertices {
+        std::vector<Vec3> positions;
+        std::vector<Vec3> normals;
+    };
+
+    // Matrices use the same column vector convention as Form3D: p' = M * p.
+    // Returns globalPose[i] * joints[i].invRootOffset for every joint.
+    extern std::vector<Mtx44> SkinMatrices(Skeleton const& skl, std::vector<Mtx44> const& globalPose);
+
+    // Linear blend skinning of positions and normals, matrices are indexed by vtxBlendIndices.
+    // Vertices are processed in blocks split on submesh boundaries across all hardware threads.
+    extern void SkinLinear(SimpleSkin const& skn, std::vector<Mtx44> const& matrices, SkinnedVertices& out);
+
+    // Dual quaternion skinning with the same inputs as SkinLinear.
+    // Matrices are converted to dual quaternions once per call and must be rigid, scale is dropped.
+    extern void SkinDualQuat(SimpleSkin const& skn, std::vector<Mtx44> const& matrices, SkinnedVertices& out);
+}
+
+#endif // RITO_SKINNING_HPP
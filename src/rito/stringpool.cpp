@@ -0,0 +1,52 @@
+#include <mutex>
+#include "stringpool.hpp"
+
+using namespace Rito;
+
+std::shared_ptr<StringPool> StringPool::shared_or_new(std::shared_ptr<StringPool> pool) {
+    return pool ? std::move(pool) : std::make_shared<StringPool>();
+}
+
+char const* StringPool::store(std::string_view value, uint32_t hash) {
+    auto const size = static_cast<uint32_t>(value.size());
+    auto const total = sizeof(size) + sizeof(hash) + value.size();
+    char* dst = nullptr;
+    if(total > blockSize / 4) {
+        dst = blocks.emplace_back(new char[total]).get();
+    } else {
+        if(total > blockSize - blockUsed) {
+            block = blocks.emplace_back(new char[blockSize]).get();
+            blockUsed = 0;
+        }
+        dst = block + blockUsed;
+        blockUsed += total;
+    }
+    memcpy(dst, &size, sizeof(size));
+    memcpy(dst + sizeof(size), &hash, sizeof(hash));
+    memcpy(dst + sizeof(size) + sizeof(hash), value.data(), value.size());
+    return dst + sizeof(size) + sizeof(hash);
+}
+
+InternedString StringPool::intern(std::string_view value) {
+    if(value.empty()) {
+        return {};
+    }
+    {
+        auto const reading = std::shared_lock(lock);
+        if(auto const i = strings.find(value); i != strings.end()) {
+            return { i->second };
+        }
+    }
+    auto const writing = std::unique_lock(lock);
+    if(auto const i = strings.find(value); i != strings.end()) {
+        return { i->second };
+    }
+    auto const stored = store(value, static_cast<uint32_t>(std::hash<std::string_view>{}(value)));
+    strings.emplace(std::string_view { stored, value.size() }, stored);
+    return { stored };
+}
+
+size_t StringPool::size() const noexcept {
+    auto const reading = std::shared_lock(lock);
+    return strings.size();
+}
@@ -0,0 +1,92 @@
+#ifndef RITO_STRINGPOOL_HPP
+#define RITO_STRINGPOOL_HPP
+#include <cinttypes>
+#include <cstring>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Rito {
+    // Handle to string stored in a StringPool. One pool keeps one copy per string, so handles of the same pool
+    // compare by pointer. Handles of different pools compare and hash by content. Reading never locks, handles
+    // stay valid for the lifetime of the pool that made them.
+    struct InternedString {
+        // Pool copy of the string, preceded by its uint32_t length and uint32_t hash
+        char const* data = nullptr;
+
+        inline std::string_view view() const noexcept {
+            if(!data) {
+                return {};
+            }
+            uint32_t size = 0;
+            memcpy(&size, data - 2 * sizeof(uint32_t), sizeof(uint32_t));
+            return { data, size };
+        }
+
+        // Same for equal strings of any pool
+        inline uint32_t hash() const noexcept {
+            if(!data) {
+                return 0;
+            }
+            uint32_t hash = 0;
+            memcpy(&hash, data - sizeof(uint32_t), sizeof(uint32_t));
+            return hash;
+        }
+
+        inline operator std::string_view() const noexcept {
+            return view();
+        }
+
+        inline std::string str() const {
+            return std::string { view() };
+        }
+
+        inline bool empty() const noexcept {
+            return data == nullptr;
+        }
+
+        inline bool operator==(InternedString const& other) const noexcept {
+            if(data == other.data) {
+                return true;
+            }
+            return data && other.data && hash() == other.hash() && view() == other.view();
+        }
+    };
+
+    // Parsed objects keep a shared_ptr to the pool their names were interned into, so names live exactly as long
+    // as some object still uses them. Pass one pool to several parsers to share names between them.
+    struct StringPool {
+    private:
+        static constexpr size_t blockSize = 64 * 1024;
+        mutable std::shared_mutex lock = {};
+        std::vector<std::unique_ptr<char[]>> blocks = {};
+        char* block = {};
+        size_t blockUsed = blockSize;
+        std::unordered_map<std::string_view, char const*> strings = {};
+
+        char const* store(std::string_view value, uint32_t hash);
+    public:
+        StringPool() = default;
+        StringPool(StringPool const&) = delete;
+        void operator=(StringPool const&) = delete;
+
+        // pool itself, or a new pool when it is null
+        static std::shared_ptr<StringPool> shared_or_new(std::shared_ptr<StringPool> pool);
+
+        InternedString intern(std::string_view value);
+
+        size_t size() const noexcept;
+    };
+}
+
+template<>
+struct std::hash<Rito::InternedString> {
+    inline size_t operator()(Rito::InternedString const& value) const noexcept {
+        return value.hash();
+    }
+};
+
+#endif // RITO_STRINGPOOL_HPP
@@ -1,4 +1,5 @@
 #include "types.hpp"
+#include <algorithm>
 
 using namespace Rito;
 
@@ -194,3 +195,16 @@ Form3D::operator Mtx43() const noexcept {
             { r20, r21, r22, r23 },
         }};
 }
+
+IndexBuffer IndexBuffer::narrowest(std::vector<uint32_t> indices) {
+    if(std::any_of(indices.begin(), indices.end(), [](uint32_t i) { return i > 0xFFFFu; })) {
+        return { std::move(indices) };
+    }
+    return { std::vector<uint16_t>(indices.begin(), indices.end()) };
+}
+
+std::vector<uint32_t> IndexBuffer::widen() const {
+    return visit([](auto const& indices) {
+        return std::vector<uint32_t>(indices.begin(), indices.end());
+    });
+}
@@ -7,6 +7,7 @@
 #include <optional>
 #include <string_view>
 #include <cmath>
+#include "hash.hpp"
 
 namespace Rito {
     struct ColorF {
@@ -133,17 +134,45 @@ namespace Rito {
         }
     };
 
-    inline constexpr uint32_t ElfHash (std::string_view view) noexcept {
-        uint32_t h = 0, high = 0;
-        for(auto const& c: view) {
-            h = (h << 4) + static_cast<uint8_t>(::tolower(c));
-            if((high = h & 0xF0000000) != 0) {
-                h ^= high >> 24;
-            }
-            h &= ~high;
+    // Index list that keeps the width it was stored with, widened only on request
+    struct IndexBuffer {
+        std::variant<std::vector<uint16_t>, std::vector<uint32_t>> data = {};
+
+        IndexBuffer() noexcept = default;
+        IndexBuffer(std::vector<uint16_t> indices) noexcept : data(std::move(indices)) {}
+        IndexBuffer(std::vector<uint32_t> indices) noexcept : data(std::move(indices)) {}
+
+        // Narrows to 16 bits when every index fits
+        static IndexBuffer narrowest(std::vector<uint32_t> indices);
+
+        inline bool wide() const noexcept {
+            return data.index() == 1;
+        }
+
+        inline size_t size() const noexcept {
+            return wide() ? std::get<1>(data).size() : std::get<0>(data).size();
+        }
+
+        inline bool empty() const noexcept {
+            return size() == 0;
         }
-        return h;
-    }
+
+        inline uint32_t operator[](size_t idx) const noexcept {
+            return wide() ? std::get<1>(data)[idx] : std::get<0>(data)[idx];
+        }
+
+        std::vector<uint32_t> widen() const;
+
+        template<typename F>
+        inline decltype(auto) visit(F&& func) {
+            return std::visit(std::forward<F>(func), data);
+        }
+
+        template<typename F>
+        inline decltype(auto) visit(F&& func) const {
+            return std::visit(std::forward<F>(func), data);
+        }
+    };
 }
 
 #endif // RITO_TYPES_HPP
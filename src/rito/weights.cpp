@@ -0,0 +1,125 @@
+#include <cmath>
+#include <numeric>
+#include "weights.hpp"
+
+using namespace Rito;
+
+namespace Rito::WeightsImpl {
+    // Slots ordered by descending weight
+    inline std::array<size_t, 4> order(std::array<float, 4> const& weights) noexcept {
+        auto result = std::array<size_t, 4> { 0, 1, 2, 3 };
+        std::stable_sort(result.begin(), result.end(), [&weights](size_t l, size_t r) {
+            return weights[l] > weights[r];
+        });
+        return result;
+    }
+
+    // Largest remainder rounding so quantized weights always sum to the max value
+    template<typename W>
+    inline std::array<W, 4> quantize(std::array<float, 4> const& weights) noexcept {
+        auto constexpr max = static_cast<int32_t>(std::numeric_limits<W>::max());
+        auto sum = 0.0f;
+        for(auto const w: weights) {
+            sum += w > 0.0f ? w : 0.0f;
+        }
+        auto result = std::array<W, 4> {};
+        if(sum <= 0.0f) {
+            return result;
+        }
+        auto remainders = std::array<float, 4> {};
+        auto total = int32_t{};
+        for(size_t k = 0; k != 4; k++) {
+            auto const scaled = (weights[k] > 0.0f ? weights[k] / sum : 0.0f) * static_cast<float>(max);
+            auto const floor = std::min(static_cast<int32_t>(scaled), max);
+            result[k] = static_cast<W>(floor);
+            remainders[k] = scaled - static_cast<float>(floor);
+            total += floor;
+        }
+        for(auto const k: order(remainders)) {
+            if(total >= max) {
+                break;
+            }
+            if(weights[k] > 0.0f) {
+                result[k]++;
+                total++;
+            }
+        }
+        return result;
+    }
+}
+
+size_t Rito::CompactWeights(SimpleSkin& skn, float epsilon) {
+    using namespace Rito::WeightsImpl;
+    file_assert(skn.vtxBlendIndices.size() == skn.vtxBlendWeights.size());
+    size_t single = 0;
+    for(size_t v = 0; v != skn.vtxBlendWeights.size(); v++) {
+        auto& indices = skn.vtxBlendIndices[v];
+        auto& weights = skn.vtxBlendWeights[v];
+        auto sum = 0.0f;
+        for(auto const w: weights) {
+            sum += w > 0.0f ? w : 0.0f;
+        }
+        if(sum <= 0.0f) {
+            continue;
+        }
+        auto const slots = order(weights);
+        auto sortedIndices = std::array<uint8_t, 4> {};
+        auto sortedWeights = std::array<float, 4> {};
+        auto kept = size_t{};
+        auto keptSum = 0.0f;
+        for(auto const k: slots) {
+            auto const w = weights[k] / sum;
+            // Heaviest influence is always kept
+            if(kept != 0 && w <= epsilon) {
+                break;
+            }
+            sortedIndices[kept] = indices[k];
+            sortedWeights[kept] = w;
+            keptSum += w;
+            kept++;
+        }
+        for(size_t k = 0; k != kept; k++) {
+            sortedWeights[k] /= keptSum;
+        }
+        for(size_t k = kept; k != 4; k++) {
+            sortedIndices[k] = sortedIndices[0];
+        }
+        if(kept == 1) {
+            sortedWeights[0] = 1.0f;
+            single++;
+        }
+        indices = sortedIndices;
+        weights = sortedWeights;
+    }
+    return single;
+}
+
+template<typename W>
+QuantizedWeights<W>::QuantizedWeights(SimpleSkin const& skn) {
+    auto const count = skn.vtxBlendWeights.size();
+    file_assert(skn.vtxBlendIndices.size() == count);
+    indices = skn.vtxBlendIndices;
+    weights.resize(count);
+    counts.resize(count);
+    for(size_t v = 0; v != count; v++) {
+        weights[v] = WeightsImpl::quantize<W>(skn.vtxBlendWeights[v]);
+        counts[v] = static_cast<uint8_t>(std::count_if(weights[v].begin(), weights[v].end(), [](W w) {
+            return w != 0;
+        }));
+    }
+}
+
+template<typename W>
+void QuantizedWeights<W>::unpack(SimpleSkin& skn) const {
+    auto const count = weights.size();
+    skn.vtxBlendIndices = indices;
+    skn.vtxBlendWeights.resize(count);
+    for(size_t v = 0; v != count; v++) {
+        for(size_t k = 0; k != 4; k++) {
+            skn.vtxBlendWeights[v][k] = static_cast<float>(weights[v][k]) / scale;
+        }
+    }
+}
+
+template struct Rito::QuantizedWeights<uint8_t>;
+template struct Rito::QuantizedWeights<uint16_t>;
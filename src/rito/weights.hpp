@@ -0,0 +1,39 @@
+#ifndef RITO_WEIGHTS_HPP
+#define RITO_WEIGHTS_HPP
+#include <cinttypes>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include "types.hpp"
+#include "simpleskin.hpp"
+
+namespace Rito {
+    // Normalizes blend weights, drops influences at or below epsilon and sorts the rest by weight,
+    // largest first. Dropped slots get weight 0 and the first joint index so they stay valid.
+    // Returns number of vertices left with a single influence.
+    extern size_t CompactWeights(SimpleSkin& skn, float epsilon = 1.0f / 255.0f);
+
+    // Blend weights quantized to 8 or 16 bits, weights of every vertex sum to exactly the max value.
+    // Quantize a compacted skin to get influences sorted and counted.
+    template<typename W>
+    struct QuantizedWeights {
+        static_assert(std::is_same_v<W, uint8_t> || std::is_same_v<W, uint16_t>);
+        static constexpr float scale = static_cast<float>(std::numeric_limits<W>::max());
+
+        std::vector<std::array<uint8_t, 4>> indices;
+        std::vector<std::array<W, 4>> weights;
+        // Influences with non zero weight
+        std::vector<uint8_t> counts;
+
+        QuantizedWeights() noexcept = default;
+        QuantizedWeights(SimpleSkin const& skn);
+
+        // Writes dequantized weights and indices back into skin
+        void unpack(SimpleSkin& skn) const;
+    };
+
+    extern template struct QuantizedWeights<uint8_t>;
+    extern template struct QuantizedWeights<uint16_t>;
+}
+
+#endif // RITO_WEIGHTS_HPP
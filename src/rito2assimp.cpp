@@ -3,20 +3,24 @@
 #include <iostream>
 #include <rito/simpleskin.hpp>
 #include <rito/skeleton.hpp>
+#include <rito/optimize.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
 // using namespace Assimp;
 using namespace Rito;
-std::unique_ptr<aiScene> Rito::ImportSkin(char const* skn_path, char const* skl_path) {
+std::unique_ptr<aiScene> Rito::ImportSkin(char const* skn_path, char const* skl_path, bool optimize) {
     auto scene = std::make_unique<aiScene>();
     auto r_skn = SimpleSkin { skn_path };
     auto r_skl = Skeleton { skl_path };
+    if(optimize) {
+        OptimizeSkin(r_skn);
+    }
 
     auto skn_name = std::filesystem::path(skn_path).filename().stem().string();
     if (r_skn.submeshes.size() == 0) {
         r_skn.submeshes.push_back({
-                                      .name = skn_name,
+                                      .name = r_skn.strings->intern(skn_name),
                                       .firstVertex = 0,
                                       .vertexCount = static_cast<int32_t>(r_skn.vtxPositions.size()),
                                       .firstIndex = 0,
@@ -52,7 +56,7 @@ std::unique_ptr<aiScene> Rito::ImportSkin(char const* skn_path, char const* skl_
     std::vector<aiMaterial*> materials = {};
     for (auto const& submesh : r_skn.submeshes) {
         auto meshNode = new aiNode();
-        meshNode->mName = submesh.name;
+        meshNode->mName = submesh.name.str();
         meshNode->mNumMeshes = 1;
         meshNode->mMeshes = new unsigned int[1] { (uint32_t)(meshes.size()) };
         sknNode->addChildren(1, &meshNode);
@@ -60,7 +64,7 @@ std::unique_ptr<aiScene> Rito::ImportSkin(char const* skn_path, char const* skl_
         auto mesh = meshes.emplace_back(new aiMesh());
         mesh->mMaterialIndex = (uint32_t)(materials.size());
         materials.emplace_back(new aiMaterial());
-        mesh->mName = submesh.name;
+        mesh->mName = submesh.name.str();
 
         mesh->mNumFaces = (uint32_t)submesh.indexCount / 3;
         mesh->mFaces = new aiFace[mesh->mNumFaces];
@@ -8,7 +8,8 @@
 #include <memory>
 
 namespace Rito {
-    extern std::unique_ptr<aiScene> ImportSkin(char const* skn, char const* skl);
+    // optimize runs OptimizeSkin with default options before conversion
+    extern std::unique_ptr<aiScene> ImportSkin(char const* skn, char const* skl, bool optimize = false);
 }
 
 